@@ -1,6 +1,7 @@
 import 'package:flutter/material.dart';
-import 'package:flutter/services.dart';
-import 'dart:convert';
+import 'package:safewayproject/risk_map.dart';
+import 'package:safewayproject/risk_map_repository.dart';
+import 'package:safewayproject/street_search_index.dart';
 
 class ExplorePage extends StatelessWidget {
   const ExplorePage({Key? key}) : super(key: key);
@@ -20,7 +21,6 @@ class StreetData {
   final double zScore;
   final String riskLevel;
   final int totalClusterNumber;
-  final String coordinateTuple;
 
   StreetData({
     required this.city,
@@ -29,18 +29,16 @@ class StreetData {
     required this.zScore,
     required this.riskLevel,
     required this.totalClusterNumber,
-    required this.coordinateTuple,
   });
 
-  factory StreetData.fromJson(Map<String, dynamic> json) {
+  factory StreetData.fromRiskMap(RiskMap riskMap, int index) {
     return StreetData(
-      city: json['City'] ?? '',
-      street: json['Street'] ?? '',
-      totalAccidents: json['Total_Accidents'] ?? 0,
-      zScore: (json['Z_score'] ?? 0).toDouble(),
-      riskLevel: json['Risk_level'] ?? 'Unknown',
-      totalClusterNumber: json['Total_Cluster_Number_DBSCAN'] ?? 0,
-      coordinateTuple: json['Coordinate_Tuple'] ?? '',
+      city: riskMap.city(index),
+      street: riskMap.street(index),
+      totalAccidents: riskMap.totalAccidents(index),
+      zScore: riskMap.zScore(index),
+      riskLevel: riskMap.riskLevel(index).label,
+      totalClusterNumber: riskMap.clusterCount(index),
     );
   }
 
@@ -56,6 +54,7 @@ class StreetRiskScreen extends StatefulWidget {
 
 class _StreetRiskScreenState extends State<StreetRiskScreen> {
   List<StreetData> streetData = [];
+  StreetSearchIndex? _searchIndex;
   StreetData? mostDangerous;
   StreetData? safest;
   bool isLoading = true;
@@ -73,13 +72,14 @@ class _StreetRiskScreenState extends State<StreetRiskScreen> {
 
   Future<void> loadData() async {
     try {
-      final String jsonString =
-          await rootBundle.loadString('assets/City_Level_Street_Risk.json');
-      final List<dynamic> jsonData = json.decode(jsonString);
+      // Home sayfasıyla aynı RiskMap örneğini paylaşıyoruz
+      final RiskMap riskMap = await RiskMapRepository().load();
 
       setState(() {
-        streetData =
-            jsonData.map((item) => StreetData.fromJson(item)).toList();
+        streetData = List<StreetData>.generate(
+          riskMap.streetCount,
+          (i) => StreetData.fromRiskMap(riskMap, i),
+        );
 
         if (streetData.isNotEmpty) {
           streetData
@@ -88,6 +88,12 @@ class _StreetRiskScreenState extends State<StreetRiskScreen> {
           safest = streetData.last;
         }
 
+        // Sıralamadan sonra: eşit eşleşmelerde kaza sayısı yüksek olan önde
+        _searchIndex = StreetSearchIndex.build(
+          [for (final s in streetData) s.street],
+          [for (final s in streetData) s.city],
+        );
+
         isLoading = false;
       });
     } catch (e) {
@@ -409,16 +415,15 @@ class _StreetRiskScreenState extends State<StreetRiskScreen> {
           const SizedBox(height: 20),
           Autocomplete<StreetData>(
             optionsBuilder: (TextEditingValue textEditingValue) {
-              final query = textEditingValue.text.trim().toLowerCase();
-
-              if (query.length < 3) {
+              final index = _searchIndex;
+              if (index == null) {
                 return const Iterable<StreetData>.empty();
               }
 
-              return streetData.where((street) {
-                return street.street.toLowerCase().contains(query) ||
-                    street.city.toLowerCase().contains(query);
-              });
+              return [
+                for (final i in index.search(textEditingValue.text))
+                  streetData[i],
+              ];
             },
             displayStringForOption: (StreetData option) =>
                 option.displayName,
@@ -0,0 +1,48 @@
+import 'dart:ui';
+
+import 'package:flutter/scheduler.dart';
+
+/// Counts frames that blow the frame budget while it is running, so jank
+/// during tracking can be compared between builds on the same phone.
+class FrameJankMonitor {
+  final Duration budget;
+
+  int _frames = 0;
+  int _jankyFrames = 0;
+  Duration _worstFrame = Duration.zero;
+  bool _running = false;
+
+  FrameJankMonitor({this.budget = const Duration(microseconds: 16667)});
+
+  void start() {
+    if (_running) return;
+    _frames = 0;
+    _jankyFrames = 0;
+    _worstFrame = Duration.zero;
+    _running = true;
+    SchedulerBinding.instance.addTimingsCallback(_onTimings);
+  }
+
+  /// Stops counting and returns a one-line summary.
+  String stop() {
+    if (_running) {
+      SchedulerBinding.instance.removeTimingsCallback(_onTimings);
+      _running = false;
+    }
+    final double percent = _frames == 0 ? 0 : 100 * _jankyFrames / _frames;
+    return 'Frames: $_frames, janky: $_jankyFrames '
+        '(${percent.toStringAsFixed(1)}%), '
+        'worst: ${_worstFrame.inMicroseconds / 1000} ms';
+  }
+
+  void _onTimings(List<FrameTiming> timings) {
+    for (final timing in timings) {
+      _frames++;
+      final Duration build = timing.buildDuration;
+      final Duration raster = timing.rasterDuration;
+      final Duration slowest = build > raster ? build : raster;
+      if (slowest > budget) _jankyFrames++;
+      if (slowest > _worstFrame) _worstFrame = slowest;
+    }
+  }
+}
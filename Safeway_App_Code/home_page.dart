@@ -1,18 +1,22 @@
 import 'dart:async';
-import 'dart:convert';
-import 'dart:math';
 import 'dart:ui';
 
 import 'package:flutter/material.dart';
-import 'package:flutter/services.dart';
-import 'package:geocoding/geocoding.dart';
 import 'package:geolocator/geolocator.dart';
 
 import 'package:safewayproject/explore_page.dart';
+import 'package:safewayproject/frame_jank_monitor.dart';
 import 'package:safewayproject/gpsanimation.dart';
 import 'package:safewayproject/main.dart';
+import 'package:safewayproject/notification_dispatch_queue.dart';
 import 'package:safewayproject/notification_service.dart';
+import 'package:safewayproject/placemark_cache.dart';
 import 'package:safewayproject/profilePage.dart';
+import 'package:safewayproject/risk_alert_engine.dart';
+import 'package:safewayproject/risk_map.dart';
+import 'package:safewayproject/risk_map_repository.dart';
+import 'package:safewayproject/risk_matching_worker.dart';
+import 'package:safewayproject/tracking_scheduler.dart';
 
 class RiskAlert {
   final Map<String, dynamic> data;
@@ -48,88 +52,75 @@ class _LocationRiskCheckerState extends State<LocationRiskChecker> {
   double? _currentAccuracy;
   bool _isDarkMode = false;
 
-  List<dynamic> _riskData = [];
+  RiskMap? _riskMap;
+  RiskMatchingWorker? _matchingWorker;
+  StreamSubscription<RiskAlertDiff>? _diffSubscription;
+  StreamSubscription<RiskClearance>? _clearanceSubscription;
+  final TrackingScheduler _trackingScheduler = TrackingScheduler();
   StreamSubscription<Position>? _positionStreamSubscription;
+  final FrameJankMonitor _jankMonitor = FrameJankMonitor();
+  bool _geocodeInFlight = false;
+  final PlacemarkCache _placemarkCache = PlacemarkCache();
   final NotificationService _notificationService = NotificationService();
-  int _notificationId = 0;
+  RiskNotificationPolicy? _notificationPolicy;
 
   static const double _searchRadiusMeters = 120.0;
+  static const bool _resolveStreetFromRiskData = true;
+  static const double _datasetStreetMatchMeters = 25.0;
+  static const String _noRiskMessage =
+      '✓ Tracking active - No risk data for current location';
 
   @override
   void initState() {
     super.initState();
-    _loadJsonData();
+    _loadRiskMap();
   }
 
   @override
   void dispose() {
     _positionStreamSubscription?.cancel();
+    _diffSubscription?.cancel();
+    _clearanceSubscription?.cancel();
+    _matchingWorker?.dispose();
+    _jankMonitor.stop();
+    _placemarkCache.flush();
     _clearAllAlerts();
     super.dispose();
   }
 
-  Future<void> _loadJsonData() async {
+  Future<void> _loadRiskMap() async {
     try {
-      final String response = await rootBundle.loadString(
-        'assets/City_Level_Street_Risk.json',
+      final riskMap = await RiskMapRepository().load();
+      // Index ve eşleştirme ayrı isolate'te, UI thread'i bloklamasın
+      final worker = await RiskMatchingWorker.spawn(
+        riskMap,
+        radiusMeters: _searchRadiusMeters,
       );
-      final data = json.decode(response);
+      if (!mounted) {
+        worker.dispose();
+        return;
+      }
+      _diffSubscription = worker.diffs.listen(_applyRiskDiff);
+      _clearanceSubscription = worker.clearances.listen((clearance) {
+        _trackingScheduler.updateClearance(
+            clearance.latitude, clearance.longitude, clearance.meters);
+      });
       setState(() {
-        _riskData = data;
+        _riskMap = riskMap;
+        _notificationPolicy = RiskNotificationPolicy(riskMap);
+        _matchingWorker = worker;
       });
+      // Yeni risk verisi varsa bir sonraki açılışta kullanılır
+      unawaited(RiskMapRepository().refresh());
     } catch (e) {
-      print('JSON loading error: $e');
+      print('Risk map loading error: $e');
+      if (!mounted) return;
       setState(() {
-        _statusMessage = 'Failed to load JSON file: $e';
+        _statusMessage = 'Failed to load risk data: $e';
       });
     }
   }
 
-  List<Map<String, double>> _parseCoordinates(String coordinateString) {
-    try {
-      final cleaned = coordinateString
-          .replaceAll('[', '')
-          .replaceAll(']', '')
-          .replaceAll('(', '')
-          .replaceAll(')', '');
-
-      final pairs = cleaned.split(', ');
-      final List<Map<String, double>> coordinates = [];
-
-      for (int i = 0; i < pairs.length - 1; i += 2) {
-        final lat = double.tryParse(pairs[i].trim());
-        final lon = double.tryParse(pairs[i + 1].trim());
-
-        if (lat != null && lon != null) {
-          coordinates.add({'lat': lat, 'lon': lon});
-        }
-      }
-
-      return coordinates;
-    } catch (e) {
-      print('Coordinate parsing error: $e');
-      return [];
-    }
-  }
-
-  double _calculateDistance(
-      double lat1, double lon1, double lat2, double lon2) {
-    const double earthRadius = 6371000;
-    final double dLat = _toRadians(lat2 - lat1);
-    final double dLon = _toRadians(lon2 - lon1);
-
-    final double a = sin(dLat / 2) * sin(dLat / 2) +
-        cos(_toRadians(lat1)) *
-            cos(_toRadians(lat2)) *
-            sin(dLon / 2) *
-            sin(dLon / 2);
-
-    final double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-    return earthRadius * c;
-  }
-
-  double _toRadians(double degree) => degree * pi / 180;
-
   Future<bool> _handleLocationPermission() async {
     bool serviceEnabled = await Geolocator.isLocationServiceEnabled();
     if (!serviceEnabled) {
@@ -169,10 +160,19 @@ class _LocationRiskCheckerState extends State<LocationRiskChecker> {
       _isTracking = true;
       _statusMessage = 'Real-time tracking active...';
     });
+    _jankMonitor.start();
+
+    _trackingScheduler.reset();
+    _listenPositions(_trackingScheduler.profile);
+  }
 
-    const LocationSettings locationSettings = LocationSettings(
-      accuracy: LocationAccuracy.high,
-      distanceFilter: 10,
+  // Scheduler profili değişince stream yeni ayarlarla yeniden açılıyor
+  void _listenPositions(TrackingProfile profile) {
+    _positionStreamSubscription?.cancel();
+
+    final LocationSettings locationSettings = LocationSettings(
+      accuracy: _locationAccuracyFor(profile.accuracy),
+      distanceFilter: profile.distanceFilter,
     );
 
     _positionStreamSubscription = Geolocator.getPositionStream(
@@ -187,111 +187,135 @@ class _LocationRiskCheckerState extends State<LocationRiskChecker> {
     );
   }
 
+  static LocationAccuracy _locationAccuracyFor(TrackingAccuracy accuracy) {
+    switch (accuracy) {
+      case TrackingAccuracy.low:
+        return LocationAccuracy.low;
+      case TrackingAccuracy.medium:
+        return LocationAccuracy.medium;
+      case TrackingAccuracy.high:
+        return LocationAccuracy.high;
+    }
+  }
+
   void _stopLocationTracking() {
     _positionStreamSubscription?.cancel();
     _positionStreamSubscription = null;
+    _matchingWorker?.reset();
     _clearAllAlerts();
+    _jankMonitor.stop();
+    _placemarkCache.flush();
     setState(() {
       _isTracking = false;
       _statusMessage = 'Tracking stopped';
     });
   }
 
-  Future<void> _updateLocation(Position position) async {
+  void _updateLocation(Position position) {
+    // Risk eşleştirmesi worker'da yapılıyor, sonuç diff olarak geri geliyor
+    _matchingWorker?.updatePosition(
+      position.latitude,
+      position.longitude,
+      speed: position.speed,
+      heading: position.heading,
+    );
+
     setState(() {
       _currentLatitude = position.latitude;
       _currentLongitude = position.longitude;
       _currentSpeed = position.speed;
       _currentAccuracy = position.accuracy;
+      if (_activeAlerts.isEmpty) {
+        _statusMessage = _noRiskMessage;
+      }
     });
 
+    _updatePlacemark(position);
+
+    final TrackingProfile? profile = _trackingScheduler.onFix(
+      position.latitude,
+      position.longitude,
+      speed: position.speed,
+      accuracy: position.accuracy,
+      alertsActive: _activeAlerts.isNotEmpty,
+    );
+    if (profile != null && _isTracking) {
+      _listenPositions(profile);
+    }
+  }
+
+  // Geocoder cevabını beklemeden devam ediyoruz; aynı anda tek istek
+  Future<void> _updatePlacemark(Position position) async {
+    if (_geocodeInFlight) return;
+    _geocodeInFlight = true;
+
     try {
-      List<Placemark> placemarks = await placemarkFromCoordinates(
+      final CachedPlacemark? place = await _placemarkCache.lookup(
         position.latitude,
         position.longitude,
+        fromDataset: _resolveStreetFromRiskData ? _nearestRiskStreet : null,
       );
 
-      if (placemarks.isNotEmpty) {
-        Placemark place = placemarks[0];
+      if (place != null && mounted) {
         setState(() {
-          _currentCity =
-              place.administrativeArea ?? place.locality ?? 'Unknown';
-          _currentStreet =
-              place.thoroughfare ?? place.street ?? 'Unknown';
+          _currentCity = place.city;
+          _currentStreet = place.street;
         });
       }
     } catch (e) {
       print('Geocoding error: $e');
+    } finally {
+      _geocodeInFlight = false;
     }
-
-    _searchNearbyRisks(position.latitude, position.longitude);
   }
 
-  void _searchNearbyRisks(double currentLat, double currentLon) {
-    try {
-      final List<
-          MapEntry<
-              Map<String, dynamic>,
-              MapEntry<List<Map<String, double>>, double>>> nearbyRisks = [];
-
-      for (var item in _riskData) {
-        final String coordinateString = item['Coordinate_Tuple'] ?? '';
-        final List<Map<String, double>> coordinates =
-            _parseCoordinates(coordinateString);
-
-        if (coordinates.isEmpty) continue;
-
-        double minDistance = double.infinity;
-
-        for (var coord in coordinates) {
-          final double distance = _calculateDistance(
-            currentLat,
-            currentLon,
-            coord['lat']!,
-            coord['lon']!,
-          );
-
-          if (distance < minDistance) {
-            minDistance = distance;
-          }
-        }
-
-        if (minDistance <= _searchRadiusMeters) {
-          nearbyRisks
-              .add(MapEntry(item, MapEntry(coordinates, minDistance)));
-        }
+  // Kullanıcı zaten bir riskli sokağın üstündeyse platform geocoder'a gerek yok
+  CachedPlacemark? _nearestRiskStreet() {
+    RiskAlert? nearest;
+    for (final alert in _activeAlerts.values) {
+      if (nearest == null || alert.distance < nearest.distance) {
+        nearest = alert;
       }
+    }
+    if (nearest == null || nearest.distance > _datasetStreetMatchMeters) {
+      return null;
+    }
+    return CachedPlacemark(
+      nearest.data['City'] ?? 'Unknown',
+      nearest.data['Street'] ?? 'Unknown',
+    );
+  }
 
-      nearbyRisks
-          .sort((a, b) => a.value.value.compareTo(b.value.value));
-
-      final Set<String> currentRiskIds = nearbyRisks
-          .map((e) => '${e.key['City']}_${e.key['Street']}')
-          .toSet();
-
-      _activeAlerts.keys
-          .where((id) => !currentRiskIds.contains(id))
-          .toList()
-          .forEach(_removeAlert);
-
-      for (var entry in nearbyRisks) {
-        final id = '${entry.key['City']}_${entry.key['Street']}';
-
-        if (!_activeAlerts.containsKey(id)) {
-          _addAlert(entry.key, entry.value.key, entry.value.value);
-        } else {
-          _activeAlerts[id]!.distance = entry.value.value;
-        }
-      }
+  void _applyRiskDiff(RiskAlertDiff diff) {
+    final RiskMap? riskMap = _riskMap;
+    if (riskMap == null || !_isTracking || !mounted) return;
 
-      setState(() {
-        _statusMessage = _activeAlerts.isEmpty
-            ? '✓ Tracking active - No risk data for current location'
-            : '⚠️ ${_activeAlerts.length} Risk area(s) detected!';
-      });
-    } catch (e) {
-      print('Search error: $e');
+    for (final street in diff.removed) {
+      _activeAlerts.remove(riskMap.id(street));
+      _notificationService.retractRiskNotification(riskMap.id(street));
+    }
+    for (final update in diff.updated) {
+      _activeAlerts[riskMap.id(update.street)]?.distance = update.distance;
+    }
+    // Kart ve bildirim aynı saat diliminin seviyesini gösterir
+    final DateTime now = DateTime.now();
+    for (final update in diff.added) {
+      _addAlert(
+        riskMap.record(update.street, slot: RiskMap.slotOf(now)),
+        riskMap.coordinates.coordinatesOf(update.street),
+        update.distance,
+      );
     }
+    for (final notice
+        in _notificationPolicy?.onDiff(diff, now) ?? const []) {
+      _showNotice(riskMap, notice);
+    }
+
+    setState(() {
+      _statusMessage = _activeAlerts.isEmpty
+          ? _noRiskMessage
+          : '⚠️ ${_activeAlerts.length} Risk area(s) detected!';
+    });
   }
 
   void _addAlert(
@@ -307,50 +331,26 @@ class _LocationRiskCheckerState extends State<LocationRiskChecker> {
       distance: distance,
     );
 
-    setState(() {
-      _activeAlerts[id] = alert;
-    });
-
-    // PREMIUM NOTIFICATION LOGIC
-    final String riskLevelRaw =
-        (riskData['Risk_level'] ?? '').toString().toLowerCase();
-
-    // Low risk için bildirim yok (sadece kartta göster)
-    if (riskLevelRaw.contains('low')) {
-      return;
-    }
-
-    String riskLevelForNotification;
-    if (riskLevelRaw.contains('high')) {
-      riskLevelForNotification = 'high';
-    } else if (riskLevelRaw.contains('medium')) {
-      riskLevelForNotification = 'medium';
-    } else {
-      riskLevelForNotification = 'medium';
-    }
-
-    // Toplam kaza sayısını int'e çevir
-    final int totalAccidents =
-        int.tryParse((riskData['Total_Accidents'] ?? '0').toString()) ?? 0;
-
-    _notificationService.showRiskNotification(
-      id: _notificationId++,
-      streetName: riskData['Street'] ?? 'Unknown street',
-      riskLevel: riskLevelForNotification,
-      distanceMeters: distance,
-      accidents: totalAccidents,
-      payload: 'instant_notification',
-    );
+    _activeAlerts[id] = alert;
   }
 
-  void _removeAlert(String id) {
-    setState(() {
-      _activeAlerts.remove(id);
-    });
+  // Hangi değişikliğin bildirim alacağına RiskNotificationPolicy, ne zaman
+  // gösterileceğine NotificationService'in kuyruğu karar veriyor
+  void _showNotice(RiskMap riskMap, RiskNotice notice) {
+    _notificationService.enqueueRiskNotification(RiskNotificationRequest(
+      key: riskMap.id(notice.street),
+      streetName: riskMap.street(notice.street),
+      isHigh: notice.level == RiskLevel.high,
+      distanceMeters: notice.distanceMeters,
+      accidents: riskMap.totalAccidents(notice.street),
+      etaSeconds: notice.etaSeconds,
+    ));
   }
 
   void _clearAllAlerts() {
     _activeAlerts.clear();
+    _notificationPolicy?.reset();
+    _notificationService.clearRiskQueue();
   }
 
   Color _getRiskColor(String? riskLevel) {
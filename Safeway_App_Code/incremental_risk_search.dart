@@ -0,0 +1,53 @@
+import 'dart:typed_data';
+
+import 'package:safewayproject/risk_spatial_index.dart';
+
+/// Radius search that reuses the previous fix's neighbourhood.
+///
+/// On a rebuild it caches every point within `radius + prefetch` of the
+/// current position (the reference point). As long as the user stays within
+/// [prefetchMeters] of that reference, every point inside the search radius
+/// is guaranteed to be in the cache, so a fix only re-ranks that small set.
+/// Moving further away triggers the next rebuild.
+class IncrementalRiskSearch {
+  final RiskSpatialIndex index;
+  final double radiusMeters;
+  final double prefetchMeters;
+
+  double? _refLat;
+  double? _refLon;
+  Int32List _candidates = Int32List(0);
+
+  /// Number of times the candidate set was rebuilt from the grid.
+  int rebuilds = 0;
+
+  IncrementalRiskSearch(
+    this.index, {
+    required this.radiusMeters,
+    this.prefetchMeters = 400,
+  });
+
+  List<RiskIndexHit> query(double lat, double lon) {
+    final double? refLat = _refLat;
+    final double? refLon = _refLon;
+
+    if (refLat == null ||
+        refLon == null ||
+        haversineMeters(refLat, refLon, lat, lon) > prefetchMeters) {
+      _candidates =
+          index.pointsWithin(lat, lon, radiusMeters + prefetchMeters);
+      _refLat = lat;
+      _refLon = lon;
+      rebuilds++;
+    }
+
+    return index.rank(_candidates, lat, lon, radiusMeters);
+  }
+
+  /// Drops the cached neighbourhood; the next query rebuilds it.
+  void reset() {
+    _refLat = null;
+    _refLon = null;
+    _candidates = Int32List(0);
+  }
+}
@@ -0,0 +1,148 @@
+/// One risk notification the app wants to show, keyed by street.
+class RiskNotificationRequest {
+  /// `City_Street`, the same id as [RiskMap.id] and the alert cards.
+  final String key;
+  final String streetName;
+  final bool isHigh;
+  final double distanceMeters;
+  final int accidents;
+
+  /// Seconds until the radius is reached, for route-ahead notices.
+  final double? etaSeconds;
+
+  const RiskNotificationRequest({
+    required this.key,
+    required this.streetName,
+    required this.isHigh,
+    required this.distanceMeters,
+    required this.accidents,
+    this.etaSeconds,
+  });
+}
+
+/// One call to the platform: a single street, or a summary of several
+/// (highest risk and nearest first).
+class RiskDispatch {
+  final int id;
+  final List<RiskNotificationRequest> requests;
+
+  const RiskDispatch(this.id, this.requests);
+
+  bool get isSummary => requests.length > 1;
+}
+
+/// Decides when risk notifications reach the platform; no Flutter here so
+/// the replay benchmarks can drive it with simulated time.
+///
+/// - Requests arriving within [window] of the first one are coalesced:
+///   one street gives its own notification, several give one summary.
+/// - Ids are stable: a street always reuses the same id and the summary
+///   has its own, so a repeat replaces the old notification in place
+///   instead of stacking a new one.
+/// - Hysteresis: a notified street that leaves the radius and comes back
+///   within [hysteresis] is treated as never having left (GPS jitter at
+///   the edge of the radius), however long the stay lasts.
+/// - Cooldown: a street notified less than [cooldown] ago is not notified
+///   again, even after a real exit.
+class RiskDispatchQueue {
+  static const int summaryId = 1000;
+  static const int _firstStreetId = summaryId + 1;
+
+  final Duration window;
+  final Duration cooldown;
+  final Duration hysteresis;
+
+  // Pencere içinde bekleyenler, sokak başına tek istek
+  final Map<String, RiskNotificationRequest> _pending = {};
+  final Map<String, int> _ids = {};
+  final Map<String, DateTime> _lastNotified = {};
+  // Bildirilmiş ve hâlâ içeride sayılan sokaklar -> çıkış zamanı (içerideyse
+  // null)
+  final Map<String, DateTime?> _stays = {};
+  DateTime? _windowEnd;
+
+  /// Requests offered and dispatches produced, for the replay benchmark.
+  int offered = 0;
+  int dispatched = 0;
+
+  RiskDispatchQueue({
+    this.window = const Duration(seconds: 3),
+    this.cooldown = const Duration(minutes: 5),
+    this.hysteresis = const Duration(seconds: 30),
+  });
+
+  /// When the open window closes, or null if nothing is pending.
+  DateTime? get windowEnd => _windowEnd;
+
+  /// Stable notification id of [key] for this session.
+  int idOf(String key) =>
+      _ids.putIfAbsent(key, () => _firstStreetId + _ids.length);
+
+  /// Queues [request]. Returns true when this opened a new window, i.e.
+  /// the caller should [flush] at [windowEnd].
+  bool offer(RiskNotificationRequest request, DateTime now) {
+    offered++;
+    if (_stays.containsKey(request.key)) {
+      final DateTime? left = _stays[request.key];
+      if (left == null || now.difference(left) < hysteresis) {
+        _stays[request.key] = null;
+        return false;
+      }
+      _stays.remove(request.key);
+    }
+
+    final DateTime? last = _lastNotified[request.key];
+    if (last != null && now.difference(last) < cooldown) return false;
+
+    // Aynı pencerede aynı sokak: son mesafe kalır
+    _pending[request.key] = request;
+    if (_windowEnd != null) return false;
+    _windowEnd = now.add(window);
+    return true;
+  }
+
+  /// [key] left the alert radius. A request still waiting for its window
+  /// is dropped: the street was only grazed.
+  void retract(String key, DateTime now) {
+    _pending.remove(key);
+    if (_stays.containsKey(key)) _stays[key] = now;
+  }
+
+  /// Closes the window and returns what to show (empty, one street or one
+  /// summary).
+  List<RiskDispatch> flush(DateTime now) {
+    _windowEnd = null;
+    _stays.removeWhere(
+        (_, left) => left != null && now.difference(left) >= hysteresis);
+    _lastNotified.removeWhere((_, last) => now.difference(last) >= cooldown);
+    if (_pending.isEmpty) return const [];
+
+    final List<RiskNotificationRequest> requests = _pending.values.toList()
+      ..sort((a, b) {
+        if (a.isHigh != b.isHigh) return a.isHigh ? -1 : 1;
+        return a.distanceMeters.compareTo(b.distanceMeters);
+      });
+    _pending.clear();
+    for (final request in requests) {
+      _lastNotified[request.key] = now;
+      // Rota tahmini henüz içeride olmak değil
+      if (request.etaSeconds == null) _stays[request.key] = null;
+    }
+
+    dispatched++;
+    return [
+      RiskDispatch(
+        requests.length == 1 ? idOf(requests.single.key) : summaryId,
+        requests,
+      ),
+    ];
+  }
+
+  /// Forgets everything, e.g. when tracking stops.
+  void clear() {
+    _pending.clear();
+    _lastNotified.clear();
+    _stays.clear();
+    _windowEnd = null;
+  }
+}
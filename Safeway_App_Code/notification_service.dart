@@ -1,5 +1,8 @@
+import 'dart:async';
+
 import 'package:flutter/material.dart';
 import 'package:flutter_local_notifications/flutter_local_notifications.dart';
+import 'package:safewayproject/notification_dispatch_queue.dart';
 import 'package:timezone/timezone.dart' as tz;
 import 'package:timezone/data/latest.dart' as tz;
 
@@ -11,6 +14,10 @@ class NotificationService {
   final FlutterLocalNotificationsPlugin _notifications =
       FlutterLocalNotificationsPlugin();
 
+  // Risk bildirimleri doğrudan değil, bu kuyruk üzerinden gidiyor
+  final RiskDispatchQueue _riskQueue = RiskDispatchQueue();
+  Timer? _riskFlushTimer;
+
   Future<void> initialize() async {
     tz.initializeTimeZones();
     tz.setLocalLocation(tz.getLocation('Europe/Istanbul'));
@@ -95,6 +102,7 @@ class NotificationService {
     required String riskLevel, // "high" veya "medium"
     required double distanceMeters,
     required int accidents,
+    double? etaSeconds, // rota tahmini: yarıçapa kaç saniye kaldı
     String? payload,
   }) async {
     final bool isHigh = riskLevel.toLowerCase() == 'high';
@@ -102,8 +110,9 @@ class NotificationService {
     final String titlePrefix =
         isHigh ? '🚨 HIGH RISK' : '⚠️ MEDIUM RISK';
 
-    final String title =
-        '$titlePrefix – ${distanceMeters.toStringAsFixed(0)} m away';
+    final String title = etaSeconds != null
+        ? '$titlePrefix – ahead in ${etaSeconds.toStringAsFixed(0)} s'
+        : '$titlePrefix – ${distanceMeters.toStringAsFixed(0)} m away';
 
     // İkinci satır: sokak adı + kaza sayısı (aynı satırda)
     final String body =
@@ -142,6 +151,106 @@ class NotificationService {
     await _notifications.show(id, title, body, details, payload: payload);
   }
 
+  /// Queues a risk notification. Requests are coalesced for a few seconds
+  /// and shown with a stable id per street; see [RiskDispatchQueue].
+  void enqueueRiskNotification(RiskNotificationRequest request) {
+    final DateTime now = DateTime.now();
+    if (_riskQueue.offer(request, now)) {
+      _riskFlushTimer?.cancel();
+      _riskFlushTimer =
+          Timer(_riskQueue.windowEnd!.difference(now), _flushRiskQueue);
+    }
+  }
+
+  /// The street [key] left the alert radius.
+  void retractRiskNotification(String key) {
+    _riskQueue.retract(key, DateTime.now());
+  }
+
+  /// Drops queued risk notifications and per-street state, e.g. when
+  /// tracking stops. Notifications already shown stay.
+  void clearRiskQueue() {
+    _riskFlushTimer?.cancel();
+    _riskFlushTimer = null;
+    _riskQueue.clear();
+  }
+
+  Future<void> _flushRiskQueue() async {
+    _riskFlushTimer = null;
+    for (final dispatch in _riskQueue.flush(DateTime.now())) {
+      if (dispatch.isSummary) {
+        await _showRiskSummary(dispatch.id, dispatch.requests);
+      } else {
+        final request = dispatch.requests.single;
+        await showRiskNotification(
+          id: dispatch.id,
+          streetName: request.streetName,
+          riskLevel: request.isHigh ? 'high' : 'medium',
+          distanceMeters: request.distanceMeters,
+          accidents: request.accidents,
+          etaSeconds: request.etaSeconds,
+          payload: request.etaSeconds != null
+              ? 'route_ahead_notification'
+              : 'instant_notification',
+        );
+      }
+    }
+  }
+
+  /// Several streets in one notification, e.g. when entering a dense
+  /// centre:
+  ///   title: 🚨 3 RISK AREAS NEARBY
+  ///   lines: 📍 Savanorių pr. – 42 m   🚗💥 14 accidents
+  Future<void> _showRiskSummary(
+    int id,
+    List<RiskNotificationRequest> requests,
+  ) async {
+    final bool anyHigh = requests.any((r) => r.isHigh);
+    final String title =
+        '${anyHigh ? '🚨' : '⚠️'} ${requests.length} RISK AREAS NEARBY';
+    final List<String> lines = [];
+    for (final r in requests) {
+      final String where = r.etaSeconds != null
+          ? 'in ${r.etaSeconds!.toStringAsFixed(0)} s'
+          : '${r.distanceMeters.toStringAsFixed(0)} m';
+      lines.add('${r.isHigh ? '🚨' : '⚠️'} ${r.streetName} – $where'
+          '   🚗💥 ${r.accidents}');
+    }
+
+    final AndroidNotificationDetails androidDetails =
+        AndroidNotificationDetails(
+      'risk_channel',
+      'Risk Alerts',
+      channelDescription:
+          'SafeWay uygulamasından yüksek / orta risk uyarıları',
+      importance: Importance.max,
+      priority: Priority.high,
+      showWhen: true,
+      playSound: true,
+      enableVibration: true,
+      icon: '@mipmap/ic_launcher',
+      largeIcon: anyHigh
+          ? const DrawableResourceAndroidBitmap('red_alert')
+          : const DrawableResourceAndroidBitmap('yellow_alert'),
+      color: anyHigh ? Colors.red : Colors.amber,
+      styleInformation: InboxStyleInformation(lines),
+    );
+
+    const DarwinNotificationDetails iosDetails = DarwinNotificationDetails(
+      presentAlert: true,
+      presentBadge: true,
+      presentSound: true,
+    );
+
+    await _notifications.show(
+      id,
+      title,
+      lines.join('\n'),
+      NotificationDetails(android: androidDetails, iOS: iosDetails),
+      payload: 'summary_notification',
+    );
+  }
+
   Future<void> scheduleNotification({
     required int id,
     required String title,
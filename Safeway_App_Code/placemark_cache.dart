@@ -0,0 +1,185 @@
+import 'dart:collection';
+import 'dart:convert';
+
+import 'package:geocoding/geocoding.dart';
+import 'package:shared_preferences/shared_preferences.dart';
+
+const String _geohashAlphabet = '0123456789bcdefghjkmnpqrstuvwxyz';
+
+/// Standard base32 geohash; precision 7 is a cell of about 150 x 150 m.
+String encodeGeohash(double lat, double lon, {int precision = 7}) {
+  double latMin = -90, latMax = 90;
+  double lonMin = -180, lonMax = 180;
+  final StringBuffer hash = StringBuffer();
+  bool evenBit = true;
+  int bit = 0;
+  int ch = 0;
+
+  while (hash.length < precision) {
+    if (evenBit) {
+      final double mid = (lonMin + lonMax) / 2;
+      if (lon >= mid) {
+        ch = (ch << 1) | 1;
+        lonMin = mid;
+      } else {
+        ch = ch << 1;
+        lonMax = mid;
+      }
+    } else {
+      final double mid = (latMin + latMax) / 2;
+      if (lat >= mid) {
+        ch = (ch << 1) | 1;
+        latMin = mid;
+      } else {
+        ch = ch << 1;
+        latMax = mid;
+      }
+    }
+    evenBit = !evenBit;
+
+    if (++bit == 5) {
+      hash.write(_geohashAlphabet[ch]);
+      bit = 0;
+      ch = 0;
+    }
+  }
+  return hash.toString();
+}
+
+class CachedPlacemark {
+  final String city;
+  final String street;
+
+  const CachedPlacemark(this.city, this.street);
+}
+
+/// Reverse-geocoding cache for the "current location" card.
+///
+/// Lookups are keyed by geohash-7 and go through an in-memory LRU, then a
+/// persistent tier in SharedPreferences, then an optional resolver backed by
+/// our own risk data, and only then the platform geocoder.
+class PlacemarkCache {
+  static const String _prefsKey = 'placemark_cache_v1';
+
+  final int precision;
+  final int memoryCapacity;
+  final int diskCapacity;
+
+  final LinkedHashMap<String, CachedPlacemark> _memory = LinkedHashMap();
+  LinkedHashMap<String, CachedPlacemark>? _disk;
+  int _unsaved = 0;
+
+  int memoryHits = 0;
+  int diskHits = 0;
+  int datasetHits = 0;
+  int platformLookups = 0;
+
+  PlacemarkCache({
+    this.precision = 7,
+    this.memoryCapacity = 256,
+    this.diskCapacity = 4000,
+  });
+
+  /// [fromDataset] is asked before the platform geocoder; returning null
+  /// falls through to the platform.
+  Future<CachedPlacemark?> lookup(
+    double lat,
+    double lon, {
+    CachedPlacemark? Function()? fromDataset,
+  }) async {
+    final String key = encodeGeohash(lat, lon, precision: precision);
+
+    final CachedPlacemark? inMemory = _memory.remove(key);
+    if (inMemory != null) {
+      _memory[key] = inMemory;
+      memoryHits++;
+      return inMemory;
+    }
+
+    final disk = await _loadDisk();
+    final CachedPlacemark? onDisk = disk.remove(key);
+    if (onDisk != null) {
+      disk[key] = onDisk;
+      _remember(key, onDisk);
+      diskHits++;
+      return onDisk;
+    }
+
+    final CachedPlacemark? fromRiskData = fromDataset?.call();
+    if (fromRiskData != null) {
+      _remember(key, fromRiskData);
+      datasetHits++;
+      return fromRiskData;
+    }
+
+    platformLookups++;
+    final List<Placemark> placemarks =
+        await placemarkFromCoordinates(lat, lon);
+    if (placemarks.isEmpty) return null;
+
+    final Placemark place = placemarks[0];
+    final result = CachedPlacemark(
+      place.administrativeArea ?? place.locality ?? 'Unknown',
+      place.thoroughfare ?? place.street ?? 'Unknown',
+    );
+    _remember(key, result);
+    _store(key, result);
+    return result;
+  }
+
+  /// Writes pending entries to the persistent tier.
+  Future<void> flush() async {
+    final disk = _disk;
+    if (disk == null || _unsaved == 0) return;
+    _unsaved = 0;
+
+    final prefs = await SharedPreferences.getInstance();
+    await prefs.setString(
+      _prefsKey,
+      json.encode({
+        for (final entry in disk.entries)
+          entry.key: [entry.value.city, entry.value.street],
+      }),
+    );
+  }
+
+  void _remember(String key, CachedPlacemark value) {
+    _memory[key] = value;
+    if (_memory.length > memoryCapacity) {
+      _memory.remove(_memory.keys.first);
+    }
+  }
+
+  void _store(String key, CachedPlacemark value) {
+    final disk = _disk!;
+    disk[key] = value;
+    if (disk.length > diskCapacity) {
+      disk.remove(disk.keys.first);
+    }
+    // Her sonuçta değil, birkaç yeni kayıtta bir diske yazıyoruz
+    if (++_unsaved >= 20) {
+      flush();
+    }
+  }
+
+  Future<LinkedHashMap<String, CachedPlacemark>> _loadDisk() async {
+    final existing = _disk;
+    if (existing != null) return existing;
+
+    final LinkedHashMap<String, CachedPlacemark> disk = LinkedHashMap();
+    try {
+      final prefs = await SharedPreferences.getInstance();
+      final String? raw = prefs.getString(_prefsKey);
+      if (raw != null) {
+        final Map<String, dynamic> decoded = json.decode(raw);
+        decoded.forEach((key, value) {
+          final List<dynamic> parts = value;
+          disk[key] = CachedPlacemark(parts[0], parts[1]);
+        });
+      }
+    } catch (e) {
+      print('Placemark cache load error: $e');
+    }
+    return _disk ??= disk;
+  }
+}
@@ -0,0 +1,254 @@
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:safewayproject/incremental_risk_search.dart';
+import 'package:safewayproject/risk_lookahead.dart';
+import 'package:safewayproject/risk_map.dart';
+import 'package:safewayproject/risk_segment_index.dart';
+import 'package:safewayproject/risk_spatial_index.dart';
+import 'package:safewayproject/tracking_scheduler.dart';
+
+/// A street entering the radius, or a new distance for one already in it.
+class RiskAlertUpdate {
+  /// Index of the street in the [RiskMap].
+  final int street;
+  final double distance;
+
+  const RiskAlertUpdate(this.street, this.distance);
+}
+
+/// What changed since the previous position, nearest first.
+class RiskAlertDiff {
+  final List<RiskAlertUpdate> added;
+  final List<int> removed;
+  final List<RiskAlertUpdate> updated;
+
+  /// Streets the current course reaches within the lookahead horizon,
+  /// each reported once until it drops out of the prediction again.
+  final List<UpcomingRisk> ahead;
+
+  const RiskAlertDiff(this.added, this.removed, this.updated,
+      [this.ahead = const []]);
+
+  bool get isEmpty =>
+      added.isEmpty && removed.isEmpty && updated.isEmpty && ahead.isEmpty;
+}
+
+/// Distance from (latitude, longitude) to the closest indexed risk, capped
+/// at [TrackingScheduler.maxClearanceMeters]. Recomputed whenever the
+/// engine rebuilds its candidate set, i.e. about every 400 m of movement.
+class RiskClearance {
+  final double latitude;
+  final double longitude;
+  final double meters;
+
+  const RiskClearance(this.latitude, this.longitude, this.meters);
+}
+
+/// The whole position -> alert path, without Flutter or isolates.
+///
+/// [RiskMatchingWorker] runs one of these in its isolate; the replay
+/// benchmarks drive it directly. Streets with road geometry are measured
+/// against their segments, the others against their cluster centres.
+class RiskAlertEngine {
+  final double radiusMeters;
+  final RiskSpatialIndex points;
+  final RiskSegmentIndex? segments;
+
+  final IncrementalRiskSearch _search;
+  final RiskLookahead _lookahead;
+  final Map<int, double> _active = {};
+  final Set<int> _announced = {};
+
+  /// Set by the [update] that rebuilt the candidate set, null otherwise.
+  RiskClearance? clearance;
+
+  RiskAlertEngine(this.points, this.segments, {required this.radiusMeters})
+      : _search = IncrementalRiskSearch(points, radiusMeters: radiusMeters),
+        _lookahead = RiskLookahead(
+          points,
+          segments: segments,
+          radiusMeters: radiusMeters,
+        );
+
+  factory RiskAlertEngine.fromRiskMap(
+    RiskMap riskMap, {
+    required double radiusMeters,
+  }) {
+    final store = riskMap.coordinates;
+    final RiskSegmentStore geometry = riskMap.segments;
+
+    // Yol geometrisi olan sokaklar segment indeksinden, diğerleri küme
+    // merkezlerinden ölçülür; bir sokak ikisinde birden olmaz
+    final List<double> lats = [];
+    final List<double> lons = [];
+    final List<int> owners = [];
+    final Int32List pointOwners = store.pointOwners();
+    for (int p = 0; p < store.pointCount; p++) {
+      if (!geometry.hasSegments(pointOwners[p])) {
+        lats.add(store.latitudes[p]);
+        lons.add(store.longitudes[p]);
+        owners.add(pointOwners[p]);
+      }
+    }
+    return RiskAlertEngine(
+      RiskSpatialIndex.build(lats, lons, owners, cellSizeMeters: radiusMeters),
+      geometry.isEmpty
+          ? null
+          : RiskSegmentIndex.build(geometry, cellSizeMeters: radiusMeters),
+      radiusMeters: radiusMeters,
+    );
+  }
+
+  /// Streets currently inside the radius, with their distances.
+  Map<int, double> get active => Map.unmodifiable(_active);
+
+  /// Feeds a fix and returns what changed. [speed] (m/s) and [heading]
+  /// (degrees) feed the lookahead; -1 when unknown.
+  RiskAlertDiff update(
+    double latitude,
+    double longitude, {
+    double speed = -1,
+    double heading = -1,
+  }) {
+    final RiskSegmentIndex? segments = this.segments;
+    final int rebuildsBefore = _search.rebuilds;
+    List<RiskIndexHit> hits = _search.query(latitude, longitude);
+
+    clearance = null;
+    // Aday küme yenilendi: en yakın riske uzaklık yeniden ölçülür
+    if (_search.rebuilds != rebuildsBefore) {
+      double meters = points.nearestDistance(
+          latitude, longitude, TrackingScheduler.maxClearanceMeters);
+      if (segments != null) {
+        meters =
+            min(meters, segments.nearestDistance(latitude, longitude, meters));
+      }
+      clearance = RiskClearance(latitude, longitude, meters);
+    }
+    if (segments != null) {
+      hits = [
+        ...hits,
+        ...segments.query(latitude, longitude, radiusMeters),
+      ]..sort((a, b) => a.distance.compareTo(b.distance));
+    }
+
+    final List<RiskAlertUpdate> added = [];
+    final List<RiskAlertUpdate> updated = [];
+    final Set<int> current = {};
+
+    for (final hit in hits) {
+      current.add(hit.owner);
+      final double? previous = _active[hit.owner];
+      if (previous == null) {
+        added.add(RiskAlertUpdate(hit.owner, hit.distance));
+      } else if (previous != hit.distance) {
+        updated.add(RiskAlertUpdate(hit.owner, hit.distance));
+      }
+      _active[hit.owner] = hit.distance;
+    }
+
+    final List<int> removed =
+        _active.keys.where((street) => !current.contains(street)).toList();
+    removed.forEach(_active.remove);
+
+    // Rota üzerindeki riskler, yarıçapa girmeden önce bir kez bildirilir
+    final List<UpcomingRisk> ahead = [];
+    final Set<int> predicted = {};
+    for (final upcoming
+        in _lookahead.query(latitude, longitude, speed, heading)) {
+      predicted.add(upcoming.street);
+      if (!_active.containsKey(upcoming.street) &&
+          _announced.add(upcoming.street)) {
+        ahead.add(upcoming);
+      }
+    }
+    _announced.removeWhere((street) =>
+        !predicted.contains(street) && !_active.containsKey(street));
+
+    return RiskAlertDiff(added, removed, updated, ahead);
+  }
+
+  /// Forgets the active set, e.g. when tracking stops.
+  void reset() {
+    _active.clear();
+    _announced.clear();
+    _search.reset();
+    _lookahead.reset();
+    clearance = null;
+  }
+}
+
+/// A notification the UI should show.
+class RiskNotice {
+  final int street;
+  final RiskLevel level;
+
+  /// Distance to the street, or along the course for a route-ahead notice.
+  final double distanceMeters;
+
+  /// Seconds until the radius is reached, for route-ahead notices only.
+  final double? etaSeconds;
+
+  const RiskNotice(this.street, this.level, this.distanceMeters,
+      [this.etaSeconds]);
+}
+
+/// Which [RiskAlertDiff] entries deserve a notification.
+///
+/// Levels are those of the two-hour slot of `now` ([RiskMap.riskLevelAt]),
+/// so a street that is only risky at rush hour stays quiet at night. Low
+/// risk streets only get a card. A street announced ahead is not
+/// notified again when it enters the radius within [preAlertValidity],
+/// nor announced twice within it.
+class RiskNotificationPolicy {
+  final RiskMap riskMap;
+  final Duration preAlertValidity;
+
+  final Set<int> _active = {};
+  final Map<int, DateTime> _preAlerted = {};
+
+  RiskNotificationPolicy(
+    this.riskMap, {
+    this.preAlertValidity = const Duration(minutes: 2),
+  });
+
+  List<RiskNotice> onDiff(RiskAlertDiff diff, DateTime now) {
+    final List<RiskNotice> notices = [];
+    final int slot = RiskMap.slotOf(now);
+    diff.removed.forEach(_active.remove);
+    // Süresi dolan ön uyarı artık hiçbir şeyi bastırmaz; hiç varılmayan
+    // sokaklar oturum boyunca birikmesin
+    _preAlerted
+        .removeWhere((_, at) => now.difference(at) >= preAlertValidity);
+
+    for (final update in diff.added) {
+      _active.add(update.street);
+      if (_preAlerted.remove(update.street) != null) continue;
+      final RiskLevel level = riskMap.riskLevelAt(update.street, slot);
+      if (level == RiskLevel.low) continue;
+      // Seviyesi bilinmeyenler orta risk gibi bildirilir
+      notices.add(RiskNotice(
+        update.street,
+        level == RiskLevel.high ? RiskLevel.high : RiskLevel.medium,
+        update.distance,
+      ));
+    }
+
+    for (final upcoming in diff.ahead) {
+      if (_active.contains(upcoming.street)) continue;
+      final RiskLevel level = riskMap.riskLevelAt(upcoming.street, slot);
+      if (level != RiskLevel.high && level != RiskLevel.medium) continue;
+      if (_preAlerted.containsKey(upcoming.street)) continue;
+      _preAlerted[upcoming.street] = now;
+      notices.add(RiskNotice(upcoming.street, level, upcoming.distanceAhead,
+          upcoming.etaSeconds));
+    }
+    return notices;
+  }
+
+  void reset() {
+    _active.clear();
+    _preAlerted.clear();
+  }
+}
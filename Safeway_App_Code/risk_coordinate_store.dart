@@ -0,0 +1,101 @@
+import 'dart:typed_data';
+
+/// All cluster centres of the risk dataset, decoded once and packed into
+/// contiguous arrays.
+///
+/// Street `i` owns the points `offsets[i] .. offsets[i + 1] - 1` of
+/// [latitudes] / [longitudes]. Nothing here allocates per GPS fix.
+class RiskCoordinateStore {
+  final Float32List latitudes;
+  final Float32List longitudes;
+  final Int32List offsets;
+
+  RiskCoordinateStore(this.latitudes, this.longitudes, this.offsets);
+
+  /// Decodes `Coordinate_Tuple` of every record. Both the numeric
+  /// `[[lat, lon], ...]` arrays written by the current exporter and the old
+  /// Python tuple strings (`"[(lat, lon), ...]"`) are accepted.
+  factory RiskCoordinateStore.fromRiskData(List<dynamic> riskData) {
+    final List<double> lats = [];
+    final List<double> lons = [];
+    final Int32List offsets = Int32List(riskData.length + 1);
+
+    for (int i = 0; i < riskData.length; i++) {
+      offsets[i] = lats.length;
+      _decodeInto(riskData[i]['Coordinate_Tuple'], lats, lons);
+    }
+    offsets[riskData.length] = lats.length;
+
+    return RiskCoordinateStore(
+      Float32List.fromList(lats),
+      Float32List.fromList(lons),
+      offsets,
+    );
+  }
+
+  int get streetCount => offsets.length - 1;
+
+  int get pointCount => latitudes.length;
+
+  int start(int street) => offsets[street];
+
+  int lengthOf(int street) => offsets[street + 1] - offsets[street];
+
+  /// Street index of every point, for building a spatial index.
+  Int32List pointOwners() {
+    final Int32List owners = Int32List(pointCount);
+    for (int street = 0; street < streetCount; street++) {
+      owners.fillRange(offsets[street], offsets[street + 1], street);
+    }
+    return owners;
+  }
+
+  /// The centres of one street in the shape [RiskAlert] keeps them.
+  List<Map<String, double>> coordinatesOf(int street) {
+    return [
+      for (int p = offsets[street]; p < offsets[street + 1]; p++)
+        {'lat': latitudes[p], 'lon': longitudes[p]},
+    ];
+  }
+
+  static void _decodeInto(
+    dynamic value,
+    List<double> lats,
+    List<double> lons,
+  ) {
+    if (value is List) {
+      for (var pair in value) {
+        if (pair is List && pair.length >= 2) {
+          lats.add((pair[0] as num).toDouble());
+          lons.add((pair[1] as num).toDouble());
+        }
+      }
+    } else if (value is String) {
+      _parseTupleString(value, lats, lons);
+    }
+  }
+
+  // Eski format: "[(54.90, 23.94), (54.88, 23.92)]"
+  static void _parseTupleString(
+    String coordinateString,
+    List<double> lats,
+    List<double> lons,
+  ) {
+    final cleaned = coordinateString
+        .replaceAll('[', '')
+        .replaceAll(']', '')
+        .replaceAll('(', '')
+        .replaceAll(')', '');
+
+    final pairs = cleaned.split(', ');
+    for (int i = 0; i < pairs.length - 1; i += 2) {
+      final lat = double.tryParse(pairs[i].trim());
+      final lon = double.tryParse(pairs[i + 1].trim());
+
+      if (lat != null && lon != null) {
+        lats.add(lat);
+        lons.add(lon);
+      }
+    }
+  }
+}
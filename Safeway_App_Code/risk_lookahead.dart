@@ -0,0 +1,229 @@
+import 'dart:math';
+
+import 'package:safewayproject/risk_segment_index.dart';
+import 'package:safewayproject/risk_spatial_index.dart';
+
+const double _metersPerDegreeLat = earthRadiusMeters * pi / 180;
+
+/// A street the current course will bring within the alert radius.
+class UpcomingRisk {
+  /// Index of the street in the [RiskMap].
+  final int street;
+
+  /// Seconds until the alert radius is reached at the current speed.
+  final double etaSeconds;
+
+  /// Metres left along the course until then.
+  final double distanceAhead;
+
+  const UpcomingRisk(this.street, this.etaSeconds, this.distanceAhead);
+}
+
+/// Predicts which risky streets the user is about to reach.
+///
+/// The course over the next [horizonSeconds] is taken as a straight ray
+/// from the fix along its heading. Only the grid cells along that ray (as
+/// wide as the alert radius) are read, and for every point or segment in
+/// them the distance along the ray at which it first comes within
+/// [radiusMeters] is solved exactly (ray vs. circle / capsule), so the
+/// result is the same radius check the worker will make later, moved
+/// forward in time.
+///
+/// Entries are cached per ray. While later fixes stay on it (small
+/// cross-track offset and heading change) and the remaining cached length
+/// still covers the horizon, a fix only shifts the cached entries by the
+/// distance travelled instead of reading the grid again.
+class RiskLookahead {
+  final RiskSpatialIndex points;
+  final RiskSegmentIndex? segments;
+  final double radiusMeters;
+  final double horizonSeconds;
+
+  /// Below this speed (m/s) the circle search alone is early enough.
+  final double minSpeed;
+
+  /// The ray is read this much further than needed, so a few fixes can
+  /// reuse it.
+  final double prefetchMeters;
+
+  final double maxCrossTrackMeters;
+  final double maxHeadingChange;
+
+  double? _originLat;
+  double? _originLon;
+  double _bearing = 0;
+  double _length = 0;
+  // street -> metres along the cached ray where the radius is entered
+  Map<int, double> _entries = {};
+
+  /// Number of times the ray was read from the grids, for benchmarks.
+  int rebuilds = 0;
+
+  RiskLookahead(
+    this.points, {
+    this.segments,
+    required this.radiusMeters,
+    this.horizonSeconds = 30,
+    this.minSpeed = 8,
+    this.prefetchMeters = 300,
+    this.maxCrossTrackMeters = 15,
+    this.maxHeadingChange = 10 * pi / 180,
+  });
+
+  /// Upcoming streets for a fix, soonest first. [headingDegrees] and
+  /// [speed] are what geolocator reports; negative or NaN means unknown
+  /// and gives no prediction.
+  List<UpcomingRisk> query(
+    double lat,
+    double lon,
+    double speed,
+    double headingDegrees,
+  ) {
+    if (!(speed >= minSpeed) || !(headingDegrees >= 0)) {
+      reset();
+      return const [];
+    }
+    final double bearing = headingDegrees * pi / 180;
+    final double needed = speed * horizonSeconds;
+
+    double along = 0;
+    final double? originLat = _originLat;
+    final double? originLon = _originLon;
+    bool reuse = false;
+    if (originLat != null && originLon != null) {
+      final double kx = _metersPerDegreeLat * cos(originLat * pi / 180);
+      final double dx = (lon - originLon) * kx;
+      final double dy = (lat - originLat) * _metersPerDegreeLat;
+      along = dx * sin(_bearing) + dy * cos(_bearing);
+      final double cross = dx * cos(_bearing) - dy * sin(_bearing);
+      double turn = (bearing - _bearing).abs() % (2 * pi);
+      turn = min(turn, 2 * pi - turn);
+      reuse = along >= 0 &&
+          cross.abs() <= maxCrossTrackMeters &&
+          turn <= maxHeadingChange &&
+          along + needed <= _length;
+    }
+    if (!reuse) {
+      _rebuild(lat, lon, bearing, needed + prefetchMeters);
+      along = 0;
+    }
+
+    final List<UpcomingRisk> upcoming = [];
+    _entries.forEach((street, entry) {
+      final double ahead = entry - along;
+      if (ahead > 0 && ahead <= needed) {
+        upcoming.add(UpcomingRisk(street, ahead / speed, ahead));
+      }
+    });
+    upcoming.sort((a, b) => a.etaSeconds.compareTo(b.etaSeconds));
+    return upcoming;
+  }
+
+  void reset() {
+    _originLat = null;
+    _originLon = null;
+    _entries = {};
+  }
+
+  void _rebuild(double lat, double lon, double bearing, double length) {
+    rebuilds++;
+    _originLat = lat;
+    _originLon = lon;
+    _bearing = bearing;
+    _length = length;
+
+    final double ux = sin(bearing);
+    final double uy = cos(bearing);
+    final double kx = _metersPerDegreeLat * cos(lat * pi / 180);
+    final double r2 = radiusMeters * radiusMeters;
+    final Map<int, double> entries = {};
+
+    void keep(int street, double? entry) {
+      if (entry == null || entry > length) return;
+      final double? best = entries[street];
+      if (best == null || entry < best) entries[street] = entry;
+    }
+
+    points.forEachInCorridor(lat, lon, bearing, length, radiusMeters,
+        (street, pLat, pLon) {
+      keep(street, _enterCircle(ux, uy, (pLon - lon) * kx,
+          (pLat - lat) * _metersPerDegreeLat, r2));
+    });
+    segments?.forEachInCorridor(lat, lon, bearing, length, radiusMeters,
+        (street, aLat, aLon, bLat, bLon) {
+      keep(
+        street,
+        _enterCapsule(
+          ux,
+          uy,
+          (aLon - lon) * kx,
+          (aLat - lat) * _metersPerDegreeLat,
+          (bLon - lon) * kx,
+          (bLat - lat) * _metersPerDegreeLat,
+        ),
+      );
+    });
+
+    // Zaten yarıçap içinde olanlar (giriş 0) normal arama ile bildiriliyor
+    entries.removeWhere((_, entry) => entry <= 0);
+    _entries = entries;
+  }
+
+  /// Smallest t >= 0 with |t*u - c| <= r, or null. 0 if already inside.
+  static double? _enterCircle(double ux, double uy, double cx, double cy,
+      double r2) {
+    final double c2 = cx * cx + cy * cy;
+    if (c2 <= r2) return 0;
+    final double b = ux * cx + uy * cy;
+    final double disc = b * b - c2 + r2;
+    if (b <= 0 || disc < 0) return null;
+    return b - sqrt(disc);
+  }
+
+  /// Smallest t >= 0 at which t*u comes within [radiusMeters] of the
+  /// segment a-b, or null.
+  double? _enterCapsule(
+    double ux,
+    double uy,
+    double ax,
+    double ay,
+    double bx,
+    double by,
+  ) {
+    final double r2 = radiusMeters * radiusMeters;
+    final double vx = bx - ax, vy = by - ay;
+    final double len2 = vx * vx + vy * vy;
+
+    // Başlangıç zaten kapsülün içindeyse giriş 0
+    double s = len2 > 0 ? -(ax * vx + ay * vy) / len2 : 0;
+    s = s < 0 ? 0 : (s > 1 ? 1 : s);
+    final double px = ax + s * vx, py = ay + s * vy;
+    if (px * px + py * py <= r2) return 0;
+
+    double? best;
+    void consider(double? t) {
+      if (t != null && (best == null || t < best!)) best = t;
+    }
+
+    consider(_enterCircle(ux, uy, ax, ay, r2));
+    consider(_enterCircle(ux, uy, bx, by, r2));
+
+    final double len = sqrt(len2);
+    if (len > 0) {
+      // Şeridin iki kenarı: AB doğrusuna ±r uzaklıktaki paralel doğrular
+      final double nx = -vy / len, ny = vx / len;
+      final double nu = nx * ux + ny * uy;
+      final double na = nx * ax + ny * ay;
+      if (nu.abs() > 1e-12) {
+        for (final double side in [radiusMeters, -radiusMeters]) {
+          final double t = (na + side) / nu;
+          if (t < 0) continue;
+          final double along =
+              ((t * ux - ax) * vx + (t * uy - ay) * vy) / len;
+          if (along >= 0 && along <= len) consider(t);
+        }
+      }
+    }
+    return best;
+  }
+}
@@ -0,0 +1,259 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:safewayproject/risk_coordinate_store.dart';
+import 'package:safewayproject/risk_segment_index.dart';
+
+enum RiskLevel { unknown, low, medium, high }
+
+extension RiskLevelLabel on RiskLevel {
+  String get label {
+    switch (this) {
+      case RiskLevel.low:
+        return 'Low Risk';
+      case RiskLevel.medium:
+        return 'Medium Risk';
+      case RiskLevel.high:
+        return 'High Risk';
+      case RiskLevel.unknown:
+        return 'Unknown';
+    }
+  }
+}
+
+/// Read-only view over a `City_Level_Street_Risk.bin` asset written by
+/// `code/6-) CSV to binary risk map.py`.
+///
+/// Every column is a typed-data view into the asset bytes; only city and
+/// street names are decoded, lazily and once each.
+class RiskMap {
+  static const int formatVersion = 4;
+
+  /// Two-hour slots of the day the per-slot levels are given for.
+  static const int slotCount = 12;
+
+  /// Per-slot levels are 2-bit codes, four to a byte.
+  static const int slotBytes = slotCount ~/ 4;
+  static const List<int> _magic = [0x53, 0x57, 0x52, 0x4D]; // "SWRM"
+
+  // Section order of the format (see the exporter).
+  static const int _secStringOffsets = 0;
+  static const int _secStringData = 1;
+  static const int _secCity = 2;
+  static const int _secStreet = 3;
+  static const int _secZScore = 4;
+  static const int _secTotalAccidents = 5;
+  static const int _secClusterCount = 6;
+  static const int _secRiskLevel = 7;
+  static const int _secCoordOffsets = 8;
+  static const int _secLatitudes = 9;
+  static const int _secLongitudes = 10;
+  // v2: road stretches, see RiskSegmentStore
+  static const int _secSegmentOffsets = 11;
+  static const int _secPolylineOffsets = 12;
+  static const int _secSegmentLatitudes = 13;
+  static const int _secSegmentLongitudes = 14;
+  // v3: risk level per street and two-hour slot
+  static const int _secSlotRiskLevel = 15;
+  static const int _sectionCountV1 = 11;
+  static const int _sectionCountV2 = 15;
+  static const int _sectionCount = 16;
+
+  final ByteData bytes;
+  final int streetCount;
+
+  /// Version of the risk data: 1 for a full export, N after delta N. Read
+  /// from the header since format v4; older maps take the value passed to
+  /// [RiskMap.fromByteData].
+  final int dataVersion;
+
+  final RiskCoordinateStore coordinates;
+
+  /// Snapped road geometry; empty for maps without it.
+  final RiskSegmentStore segments;
+
+  final Uint32List _stringOffsets;
+  final Uint8List _stringData;
+  final List<String?> _strings;
+  final Uint32List _city;
+  final Uint32List _street;
+  final Float32List _zScore;
+  final Uint32List _totalAccidents;
+  final Uint32List _clusterCount;
+  final Uint8List _riskLevel;
+
+  /// [slotBytes] per street, see [riskLevelAt]; empty for maps before v3.
+  final Uint8List _slotRiskLevel;
+
+  RiskMap._(
+    this.bytes,
+    this.streetCount,
+    this.dataVersion,
+    this.coordinates,
+    this.segments,
+    this._stringOffsets,
+    this._stringData,
+    this._city,
+    this._street,
+    this._zScore,
+    this._totalAccidents,
+    this._clusterCount,
+    this._riskLevel,
+    this._slotRiskLevel,
+  ) : _strings = List<String?>.filled(_stringOffsets.length - 1, null);
+
+  /// Opens the asset without decoding it. Throws [FormatException] for a
+  /// file that is not a risk map or has a newer format version.
+  /// [dataVersion] is used for maps written before the header carried one.
+  factory RiskMap.fromByteData(ByteData data, {int dataVersion = 1}) {
+    // Typed views need aligned offsets; platform buffers usually are, but
+    // if not we pay for a single copy here.
+    if (data.offsetInBytes % 8 != 0) {
+      final copy = Uint8List.fromList(
+        data.buffer.asUint8List(data.offsetInBytes, data.lengthInBytes),
+      );
+      data = ByteData.view(copy.buffer);
+    }
+
+    if (data.lengthInBytes < 20) {
+      throw const FormatException('Risk map is truncated');
+    }
+    for (int i = 0; i < _magic.length; i++) {
+      if (data.getUint8(i) != _magic[i]) {
+        throw const FormatException('Not a SafeWay risk map');
+      }
+    }
+    final int version = data.getUint16(4, Endian.little);
+    if (version > formatVersion) {
+      throw FormatException('Unsupported risk map version $version');
+    }
+    final int sectionCount = data.getUint16(6, Endian.little);
+    final int required = version >= 3
+        ? _sectionCount
+        : (version >= 2 ? _sectionCountV2 : _sectionCountV1);
+    if (sectionCount < required) {
+      throw const FormatException('Risk map is missing sections');
+    }
+    final int streets = data.getUint32(8, Endian.little);
+    final int points = data.getUint32(12, Endian.little);
+    final int strings = data.getUint32(16, Endian.little);
+    // v4 başlığa veri sürümünü ekledi; bölüm tablosu 4 byte kaydı
+    final int table = version >= 4 ? 24 : 20;
+    if (version >= 4) {
+      if (data.lengthInBytes < 24) {
+        throw const FormatException('Risk map is truncated');
+      }
+      dataVersion = data.getUint32(20, Endian.little);
+    }
+
+    final ByteBuffer buffer = data.buffer;
+    final int base = data.offsetInBytes;
+    int offset(int section) =>
+        base + data.getUint32(table + 4 * section, Endian.little);
+
+    final stringOffsets =
+        buffer.asUint32List(offset(_secStringOffsets), strings + 1);
+
+    RiskSegmentStore segments = RiskSegmentStore.empty(streets);
+    if (version >= 2) {
+      final streetOffsets =
+          buffer.asInt32List(offset(_secSegmentOffsets), streets + 1);
+      final polylineOffsets = buffer.asInt32List(
+          offset(_secPolylineOffsets), streetOffsets[streets] + 1);
+      final int vertices = polylineOffsets[polylineOffsets.length - 1];
+      segments = RiskSegmentStore(
+        streetOffsets,
+        polylineOffsets,
+        buffer.asFloat32List(offset(_secSegmentLatitudes), vertices),
+        buffer.asFloat32List(offset(_secSegmentLongitudes), vertices),
+      );
+    }
+
+    return RiskMap._(
+      data,
+      streets,
+      dataVersion,
+      RiskCoordinateStore(
+        buffer.asFloat32List(offset(_secLatitudes), points),
+        buffer.asFloat32List(offset(_secLongitudes), points),
+        buffer.asInt32List(offset(_secCoordOffsets), streets + 1),
+      ),
+      segments,
+      stringOffsets,
+      buffer.asUint8List(offset(_secStringData), stringOffsets[strings]),
+      buffer.asUint32List(offset(_secCity), streets),
+      buffer.asUint32List(offset(_secStreet), streets),
+      buffer.asFloat32List(offset(_secZScore), streets),
+      buffer.asUint32List(offset(_secTotalAccidents), streets),
+      buffer.asUint32List(offset(_secClusterCount), streets),
+      buffer.asUint8List(offset(_secRiskLevel), streets),
+      version >= 3
+          ? buffer.asUint8List(offset(_secSlotRiskLevel), streets * slotBytes)
+          : Uint8List(0),
+    );
+  }
+
+  String _string(int index) {
+    return _strings[index] ??= utf8.decode(
+      Uint8List.sublistView(
+        _stringData,
+        _stringOffsets[index],
+        _stringOffsets[index + 1],
+      ),
+    );
+  }
+
+  String city(int i) => _string(_city[i]);
+
+  String street(int i) => _string(_street[i]);
+
+  /// Same key the home page uses for its alerts.
+  String id(int i) => '${city(i)}_${street(i)}';
+
+  double zScore(int i) => _zScore[i];
+
+  int totalAccidents(int i) => _totalAccidents[i];
+
+  int clusterCount(int i) => _clusterCount[i];
+
+  RiskLevel riskLevel(int i) => _level(_riskLevel[i]);
+
+  /// Two-hour slot of [time] (local), 0 for 00:00-02:00.
+  static int slotOf(DateTime time) => time.hour ~/ 2;
+
+  /// Level of street [i] in [slot]; the all-day [riskLevel] when the map
+  /// or the street has no accident times.
+  RiskLevel riskLevelAt(int i, int slot) {
+    if (_slotRiskLevel.isEmpty) return riskLevel(i);
+    final int value = _slotCode(i, slot);
+    return value == 0 ? riskLevel(i) : _level(value);
+  }
+
+  int _slotCode(int i, int slot) =>
+      (_slotRiskLevel[i * slotBytes + (slot >> 2)] >> ((slot & 3) * 2)) & 3;
+
+  /// The per-slot codes of street [i] (0 = no times), for re-encoding.
+  List<int>? slotLevels(int i) => _slotRiskLevel.isEmpty
+      ? null
+      : [for (int slot = 0; slot < slotCount; slot++) _slotCode(i, slot)];
+
+  static RiskLevel _level(int value) {
+    return value < RiskLevel.values.length
+        ? RiskLevel.values[value]
+        : RiskLevel.unknown;
+  }
+
+  /// One street in the shape of the old JSON records, for UI code that
+  /// still works with maps. With [slot], `Risk_level` is the level in that
+  /// two-hour slot.
+  Map<String, dynamic> record(int i, {int? slot}) {
+    return {
+      'City': city(i),
+      'Street': street(i),
+      'Risk_level': (slot == null ? riskLevel(i) : riskLevelAt(i, slot)).label,
+      'Z_score': zScore(i),
+      'Total_Cluster_Number_DBSCAN': clusterCount(i),
+      'Total_Accidents': totalAccidents(i),
+    };
+  }
+}
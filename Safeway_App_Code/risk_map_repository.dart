@@ -0,0 +1,75 @@
+import 'package:flutter/services.dart';
+import 'package:path_provider/path_provider.dart';
+
+import 'package:safewayproject/risk_map.dart';
+import 'package:safewayproject/risk_map_updater.dart';
+
+/// Loads the risk map once and hands the same [RiskMap] to every page that
+/// asks for it. A map installed by [RiskMapUpdater] wins over the bundled
+/// asset only while its data version is newer.
+class RiskMapRepository {
+  static final RiskMapRepository _instance = RiskMapRepository._internal();
+  factory RiskMapRepository() => _instance;
+  RiskMapRepository._internal();
+
+  static const String assetPath = 'assets/City_Level_Street_Risk.bin';
+
+  /// Delta server, e.g. `--dart-define=RISK_DELTA_URL=http://10.0.2.2:8765/`
+  /// against `code/serve_risk_deltas.py`. Empty disables updates.
+  static const String deltaEndpoint = String.fromEnvironment('RISK_DELTA_URL');
+
+  Future<RiskMap>? _riskMap;
+  Future<RiskMap?>? _refresh;
+
+  Future<RiskMap> load() => _riskMap ??= _loadInstalledOrAsset();
+
+  /// Pulls pending deltas in the background. Pages that already hold a map
+  /// keep it; the next [load] (at the latest the next app start) gets the
+  /// new one.
+  Future<RiskMap?> refresh() => _refresh ??= _runUpdate();
+
+  Future<RiskMapUpdater?> _updater() async {
+    if (deltaEndpoint.isEmpty) return null;
+    final directory = await getApplicationSupportDirectory();
+    return RiskMapUpdater(directory, Uri.parse(deltaEndpoint));
+  }
+
+  Future<RiskMap> _loadInstalledOrAsset() async {
+    RiskMap? installed;
+    try {
+      installed = await (await _updater())?.readInstalled();
+    } catch (e) {
+      print('Installed risk map unreadable, using the bundled one: $e');
+    }
+    try {
+      return RiskMapUpdater.newest(installed, await _loadAsset());
+    } catch (_) {
+      if (installed != null) return installed;
+      // Bir sonraki çağrı tekrar denesin
+      _riskMap = null;
+      rethrow;
+    }
+  }
+
+  Future<RiskMap> _loadAsset() async {
+    final ByteData data = await rootBundle.load(assetPath);
+    return RiskMap.fromByteData(data);
+  }
+
+  Future<RiskMap?> _runUpdate() async {
+    try {
+      final RiskMapUpdater? updater = await _updater();
+      if (updater == null) return null;
+      final RiskMap? updated = await updater.update(_loadAsset);
+      if (updated != null) {
+        _riskMap = Future.value(updated);
+      }
+      return updated;
+    } catch (e) {
+      print('Risk map update failed: $e');
+      return null;
+    } finally {
+      _refresh = null;
+    }
+  }
+}
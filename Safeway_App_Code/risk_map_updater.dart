@@ -0,0 +1,218 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:safewayproject/risk_map.dart';
+import 'package:safewayproject/risk_map_writer.dart';
+
+/// A `risk_delta_v<N>.json` written by `code/risk_incremental.py`.
+///
+/// Upserts are whole street records (level, counts, z-score and cluster
+/// centres); removals are `City_Street` ids, the same key as
+/// [RiskMap.id] and the home page's alerts.
+class RiskDelta {
+  static const int supportedFormat = 1;
+
+  final int version;
+  final int baseVersion;
+  final List<RiskMapEntry> upserts;
+  final List<String> removals;
+
+  const RiskDelta(this.version, this.baseVersion, this.upserts, this.removals);
+
+  factory RiskDelta.fromJson(Map<String, dynamic> json) {
+    final int format = (json['format'] as num?)?.toInt() ?? 0;
+    if (format != supportedFormat) {
+      throw FormatException('Unsupported risk delta format $format');
+    }
+    return RiskDelta(
+      (json['version'] as num).toInt(),
+      (json['base_version'] as num).toInt(),
+      [
+        for (final record in json['upserts'] as List)
+          RiskMapEntry.fromJson(record as Map<String, dynamic>),
+      ],
+      [for (final id in json['removals'] as List) id as String],
+    );
+  }
+}
+
+/// [base] with [delta] applied, as a new risk map file of data version
+/// `delta.version`. Rows stay sorted
+/// by city and street, like the Python table. An upsert without
+/// `Segments` keeps the street's current road geometry.
+Uint8List applyRiskDelta(RiskMap base, RiskDelta delta) {
+  final Set<String> removed = delta.removals.toSet();
+  final Map<String, RiskMapEntry> upserts = {
+    for (final entry in delta.upserts) entry.id: entry,
+  };
+  final List<RiskMapEntry> entries = [];
+  for (int i = 0; i < base.streetCount; i++) {
+    final String id = base.id(i);
+    if (removed.contains(id)) continue;
+    final RiskMapEntry? upsert = upserts.remove(id);
+    if (upsert == null) {
+      entries.add(RiskMapEntry.fromRiskMap(base, i));
+    } else if (upsert.segments == null) {
+      // Delta'da geometri yoksa cihazdaki yol parçaları korunur
+      entries.add(upsert.withSegments(RiskMapEntry.fromRiskMap(base, i).segments));
+    } else {
+      entries.add(upsert);
+    }
+  }
+  entries.addAll(upserts.values);
+  entries.sort((a, b) {
+    final int byCity = a.city.compareTo(b.city);
+    return byCity != 0 ? byCity : a.street.compareTo(b.street);
+  });
+  return encodeRiskMap(entries, dataVersion: delta.version);
+}
+
+/// Keeps the on-device risk map in step with a delta server.
+///
+/// Installed maps live in [directory] as `City_Level_Street_Risk.v<N>.bin`.
+/// A new version is written to a `.tmp` file, flushed and renamed over, so
+/// a crash or a dropped connection leaves either the old or the new map,
+/// never a half-written one. The bundled asset carries its own
+/// [RiskMap.dataVersion]; an app release that ships newer data than the
+/// installed map wins over it ([newest]).
+///
+/// Deltas are fetched as `<endpoint>/risk_delta_v<N+1>.json` until the
+/// server answers 404, so any static file server over the directory
+/// `risk_incremental.py update` writes into works
+/// (`code/serve_risk_deltas.py` for local testing).
+class RiskMapUpdater {
+  static const String _prefix = 'City_Level_Street_Risk.v';
+  static const String _suffix = '.bin';
+
+  final Directory directory;
+  final Uri endpoint;
+  final Duration timeout;
+
+  /// Bytes received over the network by the last [update].
+  int downloadedBytes = 0;
+
+  RiskMapUpdater(
+    this.directory,
+    Uri endpoint, {
+    this.timeout = const Duration(seconds: 15),
+  }) : endpoint = endpoint.path.endsWith('/')
+            ? endpoint
+            : endpoint.replace(path: '${endpoint.path}/');
+
+  /// Newest installed version, or null if only the bundled asset exists.
+  Future<int?> installedVersion() async {
+    int? newest;
+    if (!await directory.exists()) return null;
+    await for (final entity in directory.list()) {
+      final int? version = _versionOf(entity);
+      if (version != null && (newest == null || version > newest)) {
+        newest = version;
+      }
+    }
+    return newest;
+  }
+
+  /// The newest installed map, or null if there is none (or it no longer
+  /// opens, in which case it is deleted and the asset is used again).
+  Future<RiskMap?> readInstalled() async {
+    final int? version = await installedVersion();
+    if (version == null) return null;
+    final File file = _fileFor(version);
+    try {
+      final Uint8List bytes = await file.readAsBytes();
+      // v4 öncesi kurulu haritalarda sürüm yalnızca dosya adında
+      return RiskMap.fromByteData(ByteData.sublistView(bytes),
+          dataVersion: version);
+    } on FormatException {
+      await file.delete();
+      return readInstalled();
+    }
+  }
+
+  /// [installed] if its data is newer than [bundled], else [bundled].
+  static RiskMap newest(RiskMap? installed, RiskMap bundled) =>
+      installed != null && installed.dataVersion > bundled.dataVersion
+          ? installed
+          : bundled;
+
+  /// Applies every delta newer than the current map, the [newest] of the
+  /// installed one and the one [loadBundled] returns. Returns the new map,
+  /// or null when the server had nothing newer.
+  Future<RiskMap?> update(Future<RiskMap> Function() loadBundled) async {
+    downloadedBytes = 0;
+    final HttpClient client = HttpClient()..connectionTimeout = timeout;
+    try {
+      RiskMap current = newest(await readInstalled(), await loadBundled());
+      int version = current.dataVersion;
+      RiskMap? updated;
+
+      while (true) {
+        final RiskDelta? delta = await _fetch(client, version + 1);
+        if (delta == null) break;
+        if (delta.baseVersion != version) {
+          throw StateError(
+              'Delta v${delta.version} expects v${delta.baseVersion}, '
+              'device has v$version');
+        }
+        final Uint8List bytes = applyRiskDelta(current, delta);
+        // Yazmadan önce açılabildiğini doğrula
+        current = RiskMap.fromByteData(ByteData.sublistView(bytes));
+        await _install(bytes, delta.version);
+        version = delta.version;
+        updated = current;
+      }
+      return updated;
+    } finally {
+      client.close(force: true);
+    }
+  }
+
+  Future<RiskDelta?> _fetch(HttpClient client, int version) async {
+    final Uri uri = endpoint.resolve('risk_delta_v$version.json');
+    final HttpClientRequest request =
+        await client.getUrl(uri).timeout(timeout);
+    final HttpClientResponse response = await request.close().timeout(timeout);
+    if (response.statusCode == HttpStatus.notFound) {
+      await response.drain<void>();
+      return null;
+    }
+    if (response.statusCode != HttpStatus.ok) {
+      await response.drain<void>();
+      throw HttpException('HTTP ${response.statusCode}', uri: uri);
+    }
+
+    final BytesBuilder body = BytesBuilder(copy: false);
+    await response.forEach(body.add).timeout(timeout);
+    downloadedBytes += body.length;
+    return RiskDelta.fromJson(
+        json.decode(utf8.decode(body.takeBytes())) as Map<String, dynamic>);
+  }
+
+  Future<void> _install(Uint8List bytes, int version) async {
+    await directory.create(recursive: true);
+    final File target = _fileFor(version);
+    final File tmp = File('${target.path}.tmp');
+    await tmp.writeAsBytes(bytes, flush: true);
+    await tmp.rename(target.path);
+
+    await for (final entity in directory.list()) {
+      final int? other = _versionOf(entity);
+      if (other != null && other < version) {
+        await entity.delete();
+      }
+    }
+  }
+
+  File _fileFor(int version) =>
+      File('${directory.path}${Platform.pathSeparator}$_prefix$version$_suffix');
+
+  static int? _versionOf(FileSystemEntity entity) {
+    if (entity is! File) return null;
+    final String name = entity.uri.pathSegments.last;
+    if (!name.startsWith(_prefix) || !name.endsWith(_suffix)) return null;
+    return int.tryParse(
+        name.substring(_prefix.length, name.length - _suffix.length));
+  }
+}
@@ -0,0 +1,274 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:safewayproject/risk_map.dart';
+
+/// One snapped road stretch of a street.
+class RiskPolyline {
+  final List<double> latitudes;
+  final List<double> longitudes;
+
+  const RiskPolyline(this.latitudes, this.longitudes);
+}
+
+/// One street of a risk map, decoded, for building a new map on device.
+class RiskMapEntry {
+  final String city;
+  final String street;
+  final RiskLevel riskLevel;
+  final double zScore;
+  final int totalAccidents;
+  final int clusterCount;
+  final List<double> latitudes;
+  final List<double> longitudes;
+
+  /// Road stretches; null when a delta record did not carry `Segments`,
+  /// meaning "keep what the device has".
+  final List<RiskPolyline>? segments;
+
+  /// [RiskMap.slotCount] level codes, [RiskLevel] indices where 0 means
+  /// "use [riskLevel]"; null when there are none.
+  final List<int>? slotLevels;
+
+  const RiskMapEntry({
+    required this.city,
+    required this.street,
+    required this.riskLevel,
+    required this.zScore,
+    required this.totalAccidents,
+    required this.clusterCount,
+    required this.latitudes,
+    required this.longitudes,
+    this.segments,
+    this.slotLevels,
+  });
+
+  String get id => '${city}_$street';
+
+  RiskMapEntry withSegments(List<RiskPolyline>? segments) => RiskMapEntry(
+        city: city,
+        street: street,
+        riskLevel: riskLevel,
+        zScore: zScore,
+        totalAccidents: totalAccidents,
+        clusterCount: clusterCount,
+        latitudes: latitudes,
+        longitudes: longitudes,
+        segments: segments,
+        slotLevels: slotLevels,
+      );
+
+  factory RiskMapEntry.fromRiskMap(RiskMap riskMap, int i) {
+    final store = riskMap.coordinates;
+    final geometry = riskMap.segments;
+    return RiskMapEntry(
+      city: riskMap.city(i),
+      street: riskMap.street(i),
+      riskLevel: riskMap.riskLevel(i),
+      zScore: riskMap.zScore(i),
+      totalAccidents: riskMap.totalAccidents(i),
+      clusterCount: riskMap.clusterCount(i),
+      latitudes: Float32List.sublistView(
+          store.latitudes, store.start(i), store.start(i + 1)),
+      longitudes: Float32List.sublistView(
+          store.longitudes, store.start(i), store.start(i + 1)),
+      segments: [
+        for (int p = geometry.streetOffsets[i];
+            p < geometry.streetOffsets[i + 1];
+            p++)
+          RiskPolyline(
+            Float32List.sublistView(geometry.latitudes,
+                geometry.polylineOffsets[p], geometry.polylineOffsets[p + 1]),
+            Float32List.sublistView(geometry.longitudes,
+                geometry.polylineOffsets[p], geometry.polylineOffsets[p + 1]),
+          ),
+      ],
+      slotLevels: riskMap.slotLevels(i),
+    );
+  }
+
+  /// A record in the `City_Level_Street_Risk` JSON shape
+  /// (`Coordinate_Tuple` as `[[lat, lon], ...]`, optional `Segments` as a
+  /// list of those, optional `Slot_risk_levels` as twelve level codes).
+  factory RiskMapEntry.fromJson(Map<String, dynamic> json) {
+    final List<double> lats = [];
+    final List<double> lons = [];
+    _decodePairs(json['Coordinate_Tuple'], lats, lons);
+
+    List<RiskPolyline>? segments;
+    final dynamic lines = json['Segments'];
+    if (lines is List) {
+      segments = [];
+      for (final line in lines) {
+        final List<double> lineLats = [];
+        final List<double> lineLons = [];
+        _decodePairs(line, lineLats, lineLons);
+        if (lineLats.length >= 2) {
+          segments.add(RiskPolyline(lineLats, lineLons));
+        }
+      }
+    }
+
+    final dynamic slots = json['Slot_risk_levels'];
+
+    return RiskMapEntry(
+      city: json['City'] as String,
+      street: json['Street'] as String,
+      riskLevel: riskLevelFromLabel(json['Risk_level'] as String?),
+      zScore: (json['Z_score'] as num?)?.toDouble() ?? 0,
+      totalAccidents: (json['Total_Accidents'] as num?)?.toInt() ?? 0,
+      clusterCount:
+          (json['Total_Cluster_Number_DBSCAN'] as num?)?.toInt() ?? 0,
+      latitudes: lats,
+      longitudes: lons,
+      segments: segments,
+      slotLevels: slots is List && slots.length == RiskMap.slotCount
+          ? [for (final level in slots) (level as num).toInt()]
+          : null,
+    );
+  }
+
+  static void _decodePairs(
+    dynamic value,
+    List<double> lats,
+    List<double> lons,
+  ) {
+    if (value is! List) return;
+    for (final pair in value) {
+      if (pair is List && pair.length >= 2) {
+        lats.add((pair[0] as num).toDouble());
+        lons.add((pair[1] as num).toDouble());
+      }
+    }
+  }
+}
+
+RiskLevel riskLevelFromLabel(String? label) {
+  for (final level in RiskLevel.values) {
+    if (level.label == label) return level;
+  }
+  return RiskLevel.unknown;
+}
+
+/// Serialises [entries] in the layout of `code/6-) CSV to binary risk
+/// map.py` (same string interning order, same alignment), so the result
+/// opens with [RiskMap.fromByteData] and matches the exporter byte for
+/// byte for the same rows and [dataVersion]. Entries without segments or
+/// slot levels get none.
+Uint8List encodeRiskMap(List<RiskMapEntry> entries, {int dataVersion = 1}) {
+  const int sectionCount = 16;
+  final int streets = entries.length;
+
+  final List<String> strings = [];
+  final Map<String, int> ids = {};
+  int intern(String text) => ids.putIfAbsent(text, () {
+        strings.add(text);
+        return strings.length - 1;
+      });
+
+  // Exporter gibi: önce tüm şehirler, sonra tüm sokaklar
+  final Uint32List cityIds = Uint32List(streets);
+  for (int i = 0; i < streets; i++) {
+    cityIds[i] = intern(entries[i].city);
+  }
+  final Uint32List streetIds = Uint32List(streets);
+  for (int i = 0; i < streets; i++) {
+    streetIds[i] = intern(entries[i].street);
+  }
+
+  final BytesBuilder stringData = BytesBuilder(copy: false);
+  final Uint32List stringOffsets = Uint32List(strings.length + 1);
+  for (int i = 0; i < strings.length; i++) {
+    stringData.add(utf8.encode(strings[i]));
+    stringOffsets[i + 1] = stringData.length;
+  }
+
+  final Int32List coordOffsets = Int32List(streets + 1);
+  for (int i = 0; i < streets; i++) {
+    coordOffsets[i + 1] = coordOffsets[i] + entries[i].latitudes.length;
+  }
+  final int points = coordOffsets[streets];
+  final Float32List lats = Float32List(points);
+  final Float32List lons = Float32List(points);
+  final Float32List zScores = Float32List(streets);
+  final Uint32List totals = Uint32List(streets);
+  final Uint32List clusters = Uint32List(streets);
+  final Uint8List levels = Uint8List(streets);
+  final Uint8List slotLevels = Uint8List(streets * RiskMap.slotBytes);
+
+  final Int32List segmentOffsets = Int32List(streets + 1);
+  final List<int> polylineOffsets = [0];
+  final List<double> segmentLats = [];
+  final List<double> segmentLons = [];
+
+  for (int i = 0; i < streets; i++) {
+    final entry = entries[i];
+    lats.setAll(coordOffsets[i], entry.latitudes);
+    lons.setAll(coordOffsets[i], entry.longitudes);
+    zScores[i] = entry.zScore.isNaN ? 0 : entry.zScore;
+    totals[i] = entry.totalAccidents;
+    clusters[i] = entry.clusterCount;
+    levels[i] = entry.riskLevel.index;
+    final List<int>? slots = entry.slotLevels;
+    if (slots != null) {
+      for (int k = 0; k < RiskMap.slotCount; k++) {
+        slotLevels[i * RiskMap.slotBytes + (k >> 2)] |=
+            (slots[k] & 3) << ((k & 3) * 2);
+      }
+    }
+
+    for (final line in entry.segments ?? const <RiskPolyline>[]) {
+      segmentLats.addAll(line.latitudes);
+      segmentLons.addAll(line.longitudes);
+      polylineOffsets.add(segmentLats.length);
+    }
+    segmentOffsets[i + 1] = polylineOffsets.length - 1;
+  }
+
+  final List<TypedData> sections = [
+    stringOffsets,
+    stringData.takeBytes(),
+    cityIds,
+    streetIds,
+    zScores,
+    totals,
+    clusters,
+    levels,
+    coordOffsets,
+    lats,
+    lons,
+    segmentOffsets,
+    Int32List.fromList(polylineOffsets),
+    Float32List.fromList(segmentLats),
+    Float32List.fromList(segmentLons),
+    slotLevels,
+  ];
+
+  const int headerSize = 4 + 2 + 2 + 4 * 4 + 4 * sectionCount;
+  final List<int> offsets = [];
+  int position = headerSize;
+  for (final section in sections) {
+    position += (-position) % 8;
+    offsets.add(position);
+    position += section.lengthInBytes;
+  }
+
+  final Uint8List out = Uint8List(position);
+  final ByteData header = ByteData.sublistView(out);
+  out.setAll(0, ascii.encode('SWRM'));
+  header.setUint16(4, RiskMap.formatVersion, Endian.little);
+  header.setUint16(6, sectionCount, Endian.little);
+  header.setUint32(8, streets, Endian.little);
+  header.setUint32(12, points, Endian.little);
+  header.setUint32(16, strings.length, Endian.little);
+  header.setUint32(20, dataVersion, Endian.little);
+  for (int s = 0; s < sectionCount; s++) {
+    header.setUint32(24 + 4 * s, offsets[s], Endian.little);
+    out.setAll(
+      offsets[s],
+      sections[s].buffer.asUint8List(
+          sections[s].offsetInBytes, sections[s].lengthInBytes),
+    );
+  }
+  return out;
+}
@@ -0,0 +1,129 @@
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:safewayproject/risk_alert_engine.dart';
+import 'package:safewayproject/risk_map.dart';
+
+export 'package:safewayproject/risk_alert_engine.dart'
+    show RiskAlertDiff, RiskAlertUpdate, RiskClearance;
+
+class _WorkerConfig {
+  final SendPort replyTo;
+  final Uint8List riskMapBytes;
+  final double radiusMeters;
+
+  const _WorkerConfig(this.replyTo, this.riskMapBytes, this.radiusMeters);
+}
+
+class _PositionMessage {
+  final double latitude;
+  final double longitude;
+  final double speed;
+  final double heading;
+
+  const _PositionMessage(
+      this.latitude, this.longitude, this.speed, this.heading);
+}
+
+const String _resetMessage = 'reset';
+
+/// Long-lived isolate that runs a [RiskAlertEngine], so the UI isolate only
+/// receives small [RiskAlertDiff]s.
+class RiskMatchingWorker {
+  final Isolate _isolate;
+  final SendPort _commands;
+  final ReceivePort _responses;
+
+  /// Non-empty diffs, in the order positions were sent.
+  final Stream<RiskAlertDiff> diffs;
+
+  /// Clearance reports for the tracking scheduler.
+  final Stream<RiskClearance> clearances;
+
+  RiskMatchingWorker._(
+    this._isolate,
+    this._commands,
+    this._responses,
+    this.diffs,
+    this.clearances,
+  );
+
+  static Future<RiskMatchingWorker> spawn(
+    RiskMap riskMap, {
+    required double radiusMeters,
+  }) async {
+    final ReceivePort responses = ReceivePort();
+    final Isolate isolate = await Isolate.spawn(
+      _workerMain,
+      _WorkerConfig(
+        responses.sendPort,
+        Uint8List.sublistView(riskMap.bytes),
+        radiusMeters,
+      ),
+      debugName: 'risk-matching',
+    );
+
+    final Stream<dynamic> events = responses.asBroadcastStream();
+    final SendPort commands = await events.first as SendPort;
+    final Stream<RiskAlertDiff> diffs =
+        events.where((m) => m is RiskAlertDiff).cast<RiskAlertDiff>();
+    final Stream<RiskClearance> clearances =
+        events.where((m) => m is RiskClearance).cast<RiskClearance>();
+
+    return RiskMatchingWorker._(
+        isolate, commands, responses, diffs, clearances);
+  }
+
+  /// [speed] (m/s) and [heading] (degrees) feed the lookahead; pass -1
+  /// when unknown.
+  void updatePosition(
+    double latitude,
+    double longitude, {
+    double speed = -1,
+    double heading = -1,
+  }) {
+    _commands.send(_PositionMessage(latitude, longitude, speed, heading));
+  }
+
+  /// Forgets the active set, e.g. when tracking stops.
+  void reset() {
+    _commands.send(_resetMessage);
+  }
+
+  void dispose() {
+    _responses.close();
+    _isolate.kill(priority: Isolate.beforeNextEvent);
+  }
+}
+
+void _workerMain(_WorkerConfig config) {
+  final ReceivePort commands = ReceivePort();
+  config.replyTo.send(commands.sendPort);
+
+  final RiskMap riskMap =
+      RiskMap.fromByteData(ByteData.sublistView(config.riskMapBytes));
+  final RiskAlertEngine engine = RiskAlertEngine.fromRiskMap(
+    riskMap,
+    radiusMeters: config.radiusMeters,
+  );
+
+  commands.listen((message) {
+    if (message is _PositionMessage) {
+      final RiskAlertDiff diff = engine.update(
+        message.latitude,
+        message.longitude,
+        speed: message.speed,
+        heading: message.heading,
+      );
+      final RiskClearance? clearance = engine.clearance;
+      if (clearance != null) {
+        config.replyTo.send(clearance);
+      }
+      if (!diff.isEmpty) {
+        config.replyTo.send(diff);
+      }
+    } else if (message == _resetMessage) {
+      engine.reset();
+    }
+  });
+}
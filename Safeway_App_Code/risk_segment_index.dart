@@ -0,0 +1,296 @@
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:safewayproject/risk_spatial_index.dart';
+
+const double _metersPerDegreeLat = earthRadiusMeters * pi / 180;
+
+double _toRadians(double degree) => degree * pi / 180;
+
+/// Road stretches of the risky streets (`code/snap_clusters_to_osm.py`),
+/// packed like [RiskCoordinateStore].
+///
+/// Street `i` owns the polylines `streetOffsets[i] .. streetOffsets[i + 1] - 1`
+/// and polyline `p` the vertices `polylineOffsets[p] .. polylineOffsets[p + 1] - 1`
+/// of [latitudes] / [longitudes].
+class RiskSegmentStore {
+  final Int32List streetOffsets;
+  final Int32List polylineOffsets;
+  final Float32List latitudes;
+  final Float32List longitudes;
+
+  RiskSegmentStore(
+    this.streetOffsets,
+    this.polylineOffsets,
+    this.latitudes,
+    this.longitudes,
+  );
+
+  /// No geometry for any of [streets] (maps older than format 2).
+  factory RiskSegmentStore.empty(int streets) => RiskSegmentStore(
+        Int32List(streets + 1),
+        Int32List(1),
+        Float32List(0),
+        Float32List(0),
+      );
+
+  int get polylineCount => polylineOffsets.length - 1;
+
+  bool get isEmpty => polylineCount == 0;
+
+  bool hasSegments(int street) =>
+      streetOffsets[street + 1] > streetOffsets[street];
+}
+
+/// Uniform grid over every segment (consecutive vertex pair) of a
+/// [RiskSegmentStore]. A segment is listed in every cell its bounding box
+/// touches, so a radius query only looks at the cells around the position
+/// and measures the distance to the road itself, not to the nearest
+/// stored point.
+class RiskSegmentIndex {
+  final double cellSizeMeters;
+  final double _cellLat;
+  final double _cellLon;
+
+  // SoA: segment s runs from (_aLat[s], _aLon[s]) to (_bLat[s], _bLon[s])
+  final Float64List _aLat;
+  final Float64List _aLon;
+  final Float64List _bLat;
+  final Float64List _bLon;
+  final Int32List _owner;
+
+  final Map<int, int> _cellSlot;
+  final Int32List _slotStart;
+  final Int32List _cellSegments;
+
+  // Bir segment birden çok hücrede olabilir, sorgu başına bir kez ölç
+  final Int32List _seenAt;
+  int _stamp = 0;
+
+  /// Number of point-to-segment evaluations made so far, for benchmarks.
+  int distanceChecks = 0;
+
+  RiskSegmentIndex._(
+    this.cellSizeMeters,
+    this._cellLat,
+    this._cellLon,
+    this._aLat,
+    this._aLon,
+    this._bLat,
+    this._bLon,
+    this._owner,
+    this._cellSlot,
+    this._slotStart,
+    this._cellSegments,
+  ) : _seenAt = Int32List(_owner.length);
+
+  int get length => _owner.length;
+
+  factory RiskSegmentIndex.build(
+    RiskSegmentStore store, {
+    double cellSizeMeters = 120,
+  }) {
+    final aLat = <double>[], aLon = <double>[];
+    final bLat = <double>[], bLon = <double>[];
+    final owners = <int>[];
+    double maxAbsLat = 0;
+
+    final int streets = store.streetOffsets.length - 1;
+    for (int street = 0; street < streets; street++) {
+      for (int p = store.streetOffsets[street];
+          p < store.streetOffsets[street + 1];
+          p++) {
+        for (int v = store.polylineOffsets[p];
+            v + 1 < store.polylineOffsets[p + 1];
+            v++) {
+          aLat.add(store.latitudes[v]);
+          aLon.add(store.longitudes[v]);
+          bLat.add(store.latitudes[v + 1]);
+          bLon.add(store.longitudes[v + 1]);
+          owners.add(street);
+          maxAbsLat = max(maxAbsLat, store.latitudes[v].abs());
+        }
+      }
+    }
+
+    final double cellLat = cellSizeMeters / _metersPerDegreeLat;
+    final double cellLon =
+        cellSizeMeters / (_metersPerDegreeLat * _safeCos(maxAbsLat));
+
+    // (cell key, segment) pairs, sorted by cell
+    final List<int> keys = [];
+    final List<int> segs = [];
+    for (int s = 0; s < owners.length; s++) {
+      final int rowMin = (min(aLat[s], bLat[s]) / cellLat).floor();
+      final int rowMax = (max(aLat[s], bLat[s]) / cellLat).floor();
+      final int colMin = (min(aLon[s], bLon[s]) / cellLon).floor();
+      final int colMax = (max(aLon[s], bLon[s]) / cellLon).floor();
+      for (int row = rowMin; row <= rowMax; row++) {
+        for (int col = colMin; col <= colMax; col++) {
+          keys.add(_key(row, col));
+          segs.add(s);
+        }
+      }
+    }
+    final List<int> order = List<int>.generate(keys.length, (i) => i)
+      ..sort((a, b) => keys[a].compareTo(keys[b]));
+
+    final Int32List cellSegments = Int32List(keys.length);
+    final Map<int, int> cellSlot = {};
+    final List<int> slotStart = [];
+    for (int i = 0; i < order.length; i++) {
+      cellSegments[i] = segs[order[i]];
+      final int key = keys[order[i]];
+      if (!cellSlot.containsKey(key)) {
+        cellSlot[key] = slotStart.length;
+        slotStart.add(i);
+      }
+    }
+    slotStart.add(order.length);
+
+    return RiskSegmentIndex._(
+      cellSizeMeters,
+      cellLat,
+      cellLon,
+      Float64List.fromList(aLat),
+      Float64List.fromList(aLon),
+      Float64List.fromList(bLat),
+      Float64List.fromList(bLon),
+      Int32List.fromList(owners),
+      cellSlot,
+      Int32List.fromList(slotStart),
+      cellSegments,
+    );
+  }
+
+  static int _key(int row, int col) => gridCellKey(row, col);
+
+  static double _safeCos(double latDegrees) =>
+      max(cos(_toRadians(min(latDegrees, 89.0))), 1e-6);
+
+  /// Calls [visit] once with every segment in the cells of
+  /// [corridorCellKeys] for this grid, for the lookahead.
+  void forEachInCorridor(
+    double lat,
+    double lon,
+    double bearing,
+    double lengthMeters,
+    double halfWidthMeters,
+    void Function(int owner, double aLat, double aLon, double bLat,
+            double bLon)
+        visit,
+  ) {
+    _nextStamp();
+    for (final int key in corridorCellKeys(lat, lon, bearing, lengthMeters,
+        halfWidthMeters, _cellLat, _cellLon)) {
+      final int? slot = _cellSlot[key];
+      if (slot == null) continue;
+      final int end = _slotStart[slot + 1];
+      for (int i = _slotStart[slot]; i < end; i++) {
+        final int s = _cellSegments[i];
+        if (_seenAt[s] == _stamp) continue;
+        _seenAt[s] = _stamp;
+        distanceChecks++;
+        visit(_owner[s], _aLat[s], _aLon[s], _bLat[s], _bLon[s]);
+      }
+    }
+  }
+
+  void _nextStamp() {
+    if (++_stamp == 0x7FFFFFFF) {
+      _seenAt.fillRange(0, _seenAt.length, 0);
+      _stamp = 1;
+    }
+  }
+
+  /// Distance to the closest road stretch, searched ring by ring like
+  /// [RiskSpatialIndex.nearestDistance]; [maxMeters] if none is that close.
+  double nearestDistance(double lat, double lon, double maxMeters) {
+    final int row = (lat / _cellLat).floor();
+    final int col = (lon / _cellLon).floor();
+    final double cellMeters = min(cellSizeMeters,
+        _cellLon * _metersPerDegreeLat * _safeCos(lat.abs()));
+    final double kx = _metersPerDegreeLat * cos(_toRadians(lat));
+
+    _nextStamp();
+    double best = maxMeters;
+    for (int ring = 0; (ring - 1) * cellMeters <= best; ring++) {
+      forEachRingCell(row, col, ring, (key) {
+        final int? slot = _cellSlot[key];
+        if (slot == null) return;
+        final int end = _slotStart[slot + 1];
+        for (int i = _slotStart[slot]; i < end; i++) {
+          final int s = _cellSegments[i];
+          if (_seenAt[s] == _stamp) continue;
+          _seenAt[s] = _stamp;
+          distanceChecks++;
+          best = min(best, _segmentDistance(s, lat, lon, kx));
+        }
+      });
+    }
+    return best;
+  }
+
+  // Yerel düzlemde nokta-segment uzaklığı (metre)
+  double _segmentDistance(int s, double lat, double lon, double kx) {
+    const double ky = _metersPerDegreeLat;
+    final double ax = (_aLon[s] - lon) * kx;
+    final double ay = (_aLat[s] - lat) * ky;
+    final double dx = (_bLon[s] - lon) * kx - ax;
+    final double dy = (_bLat[s] - lat) * ky - ay;
+    final double len2 = dx * dx + dy * dy;
+    double t = len2 > 0 ? -(ax * dx + ay * dy) / len2 : 0;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    final double px = ax + t * dx;
+    final double py = ay + t * dy;
+    return sqrt(px * px + py * py);
+  }
+
+  /// Streets with a road stretch within [radiusMeters] of the position,
+  /// nearest first, each with its distance to the closest segment.
+  List<RiskIndexHit> query(double lat, double lon, double radiusMeters) {
+    final double dLat = radiusMeters / _metersPerDegreeLat;
+    final double dLon =
+        radiusMeters / (_metersPerDegreeLat * _safeCos(lat.abs() + dLat));
+
+    // Sorgu noktası etrafında yerel düzlem (metre); birkaç yüz metrede
+    // haversine ile fark milimetre mertebesinde
+    final double kx = _metersPerDegreeLat * cos(_toRadians(lat));
+
+    _nextStamp();
+
+    final Map<int, double> nearest = {};
+    final int rowMin = ((lat - dLat) / _cellLat).floor();
+    final int rowMax = ((lat + dLat) / _cellLat).floor();
+    final int colMin = ((lon - dLon) / _cellLon).floor();
+    final int colMax = ((lon + dLon) / _cellLon).floor();
+
+    for (int row = rowMin; row <= rowMax; row++) {
+      for (int col = colMin; col <= colMax; col++) {
+        final int? slot = _cellSlot[_key(row, col)];
+        if (slot == null) continue;
+
+        final int end = _slotStart[slot + 1];
+        for (int i = _slotStart[slot]; i < end; i++) {
+          final int s = _cellSegments[i];
+          if (_seenAt[s] == _stamp) continue;
+          _seenAt[s] = _stamp;
+          distanceChecks++;
+
+          final double distance = _segmentDistance(s, lat, lon, kx);
+          if (distance > radiusMeters) continue;
+
+          final int street = _owner[s];
+          final double? best = nearest[street];
+          if (best == null || distance < best) nearest[street] = distance;
+        }
+      }
+    }
+
+    final List<RiskIndexHit> hits = [
+      for (final entry in nearest.entries) RiskIndexHit(entry.key, entry.value),
+    ];
+    hits.sort((a, b) => a.distance.compareTo(b.distance));
+    return hits;
+  }
+}
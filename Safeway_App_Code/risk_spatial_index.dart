@@ -0,0 +1,338 @@
+import 'dart:math';
+import 'dart:typed_data';
+
+const double earthRadiusMeters = 6371000;
+const double _metersPerDegreeLat = earthRadiusMeters * pi / 180;
+
+double _toRadians(double degree) => degree * pi / 180;
+
+/// Great-circle distance in metres (same formula the home page always used).
+double haversineMeters(double lat1, double lon1, double lat2, double lon2) {
+  final double dLat = _toRadians(lat2 - lat1);
+  final double dLon = _toRadians(lon2 - lon1);
+
+  final double a = sin(dLat / 2) * sin(dLat / 2) +
+      cos(_toRadians(lat1)) *
+          cos(_toRadians(lat2)) *
+          sin(dLon / 2) *
+          sin(dLon / 2);
+
+  final double c = 2 * atan2(sqrt(a), sqrt(1 - a));
+  return earthRadiusMeters * c;
+}
+
+/// Keys (as [RiskSpatialIndex] and [RiskSegmentIndex] build them) of every
+/// grid cell that may hold something within [halfWidthMeters] of the line
+/// from (lat, lon) running [lengthMeters] along [bearing] (radians, 0 =
+/// north, clockwise). Cells are [cellLat] x [cellLon] degrees.
+Set<int> corridorCellKeys(
+  double lat,
+  double lon,
+  double bearing,
+  double lengthMeters,
+  double halfWidthMeters,
+  double cellLat,
+  double cellLon,
+) {
+  // Her örnek noktası etrafında (yarı genişlik + adım/2)'lik kare: çizgiye
+  // halfWidth mesafedeki her nokta bir örneğin o karesine düşer
+  final double step = cellLat * _metersPerDegreeLat / 2;
+  final double reach = halfWidthMeters + step / 2;
+  final double metersPerDegreeLon =
+      _metersPerDegreeLat * max(cos(_toRadians(lat)), 1e-6);
+  final double dLat = reach / _metersPerDegreeLat;
+  final double dLon = reach / metersPerDegreeLon;
+
+  final Set<int> keys = {};
+  final int samples = (lengthMeters / step).ceil();
+  for (int k = 0; k <= samples; k++) {
+    final double along = min(k * step, lengthMeters);
+    final double sLat = lat + along * cos(bearing) / _metersPerDegreeLat;
+    final double sLon = lon + along * sin(bearing) / metersPerDegreeLon;
+    final int rowMax = ((sLat + dLat) / cellLat).floor();
+    final int colMax = ((sLon + dLon) / cellLon).floor();
+    for (int row = ((sLat - dLat) / cellLat).floor(); row <= rowMax; row++) {
+      for (int col = ((sLon - dLon) / cellLon).floor(); col <= colMax; col++) {
+        keys.add(gridCellKey(row, col));
+      }
+    }
+  }
+  return keys;
+}
+
+int gridCellKey(int row, int col) => (row << 32) | (col & 0xFFFFFFFF);
+
+/// Calls [visit] with the key of every cell exactly [ring] cells away
+/// (Chebyshev) from (row, col); ring 0 is the cell itself.
+void forEachRingCell(int row, int col, int ring, void Function(int key) visit) {
+  if (ring == 0) {
+    visit(gridCellKey(row, col));
+    return;
+  }
+  for (int c = col - ring; c <= col + ring; c++) {
+    visit(gridCellKey(row - ring, c));
+    visit(gridCellKey(row + ring, c));
+  }
+  for (int r = row - ring + 1; r < row + ring; r++) {
+    visit(gridCellKey(r, col - ring));
+    visit(gridCellKey(r, col + ring));
+  }
+}
+
+/// One street that has at least one cluster centre inside the query radius.
+class RiskIndexHit {
+  /// Index of the street in the risk dataset.
+  final int owner;
+
+  /// Distance to the nearest cluster centre of that street, in metres.
+  final double distance;
+
+  const RiskIndexHit(this.owner, this.distance);
+}
+
+/// Uniform lat/lon grid over all DBSCAN cluster centres.
+///
+/// Points are sorted by cell once at build time, so every cell is a
+/// contiguous range of the packed arrays. A radius query only visits the
+/// handful of cells that overlap the search circle instead of the whole
+/// dataset.
+class RiskSpatialIndex {
+  final double cellSizeMeters;
+  final double _cellLat;
+  final double _cellLon;
+
+  final Float64List _lat;
+  final Float64List _lon;
+  final Int32List _owner;
+
+  final Map<int, int> _cellSlot;
+  final Int32List _slotStart;
+
+  RiskSpatialIndex._(
+    this.cellSizeMeters,
+    this._cellLat,
+    this._cellLon,
+    this._lat,
+    this._lon,
+    this._owner,
+    this._cellSlot,
+    this._slotStart,
+  );
+
+  int get length => _owner.length;
+
+  /// Builds the grid from parallel lists: point `i` sits at
+  /// (`latitudes[i]`, `longitudes[i]`) and belongs to street `owners[i]`.
+  ///
+  /// [cellSizeMeters] should be about the search radius; a query then only
+  /// has to look at a 3x3 block of cells.
+  factory RiskSpatialIndex.build(
+    List<double> latitudes,
+    List<double> longitudes,
+    List<int> owners, {
+    double cellSizeMeters = 120,
+  }) {
+    final int n = owners.length;
+
+    // Longitude cells are sized for the most northern point so that a cell
+    // is never narrower than cellSizeMeters anywhere in the dataset.
+    double maxAbsLat = 0;
+    for (int i = 0; i < n; i++) {
+      maxAbsLat = max(maxAbsLat, latitudes[i].abs());
+    }
+    final double cellLat = cellSizeMeters / _metersPerDegreeLat;
+    final double cellLon =
+        cellSizeMeters / (_metersPerDegreeLat * _safeCos(maxAbsLat));
+
+    final List<int> keys = List<int>.filled(n, 0);
+    for (int i = 0; i < n; i++) {
+      keys[i] = _key(
+        (latitudes[i] / cellLat).floor(),
+        (longitudes[i] / cellLon).floor(),
+      );
+    }
+
+    final List<int> order = List<int>.generate(n, (i) => i);
+    order.sort((a, b) => keys[a].compareTo(keys[b]));
+
+    final Float64List lat = Float64List(n);
+    final Float64List lon = Float64List(n);
+    final Int32List owner = Int32List(n);
+    final Map<int, int> cellSlot = {};
+    final List<int> slotStart = [];
+
+    for (int i = 0; i < n; i++) {
+      final int src = order[i];
+      lat[i] = latitudes[src];
+      lon[i] = longitudes[src];
+      owner[i] = owners[src];
+
+      final int key = keys[src];
+      if (!cellSlot.containsKey(key)) {
+        cellSlot[key] = slotStart.length;
+        slotStart.add(i);
+      }
+    }
+    slotStart.add(n);
+
+    return RiskSpatialIndex._(
+      cellSizeMeters,
+      cellLat,
+      cellLon,
+      lat,
+      lon,
+      owner,
+      cellSlot,
+      Int32List.fromList(slotStart),
+    );
+  }
+
+  static int _key(int row, int col) => gridCellKey(row, col);
+
+  static double _safeCos(double latDegrees) =>
+      max(cos(_toRadians(min(latDegrees, 89.0))), 1e-6);
+
+  /// Number of haversine evaluations made so far, for benchmarks.
+  int distanceChecks = 0;
+
+  /// Streets with a cluster centre within [radiusMeters] of the given
+  /// position, nearest first. Each street appears once, with the distance to
+  /// its closest centre.
+  List<RiskIndexHit> query(double lat, double lon, double radiusMeters) {
+    final Map<int, double> nearest = {};
+    _forEachCandidate(lat, lon, radiusMeters, (i) {
+      _visit(i, lat, lon, radiusMeters, nearest);
+    });
+    return _sortedHits(nearest);
+  }
+
+  /// Packed indices of all points within [radiusMeters]; feed them back to
+  /// [rank] to re-query a small area without touching the grid again.
+  Int32List pointsWithin(double lat, double lon, double radiusMeters) {
+    final List<int> points = [];
+    _forEachCandidate(lat, lon, radiusMeters, (i) {
+      distanceChecks++;
+      if (haversineMeters(lat, lon, _lat[i], _lon[i]) <= radiusMeters) {
+        points.add(i);
+      }
+    });
+    return Int32List.fromList(points);
+  }
+
+  /// Same result as [query], but only [candidates] (from [pointsWithin])
+  /// are looked at.
+  List<RiskIndexHit> rank(
+    Int32List candidates,
+    double lat,
+    double lon,
+    double radiusMeters,
+  ) {
+    final Map<int, double> nearest = {};
+    for (final i in candidates) {
+      _visit(i, lat, lon, radiusMeters, nearest);
+    }
+    return _sortedHits(nearest);
+  }
+
+  /// Calls [visit] with every point in the cells of [corridorCellKeys] for
+  /// this grid, for the lookahead.
+  void forEachInCorridor(
+    double lat,
+    double lon,
+    double bearing,
+    double lengthMeters,
+    double halfWidthMeters,
+    void Function(int owner, double lat, double lon) visit,
+  ) {
+    for (final int key in corridorCellKeys(lat, lon, bearing, lengthMeters,
+        halfWidthMeters, _cellLat, _cellLon)) {
+      final int? slot = _cellSlot[key];
+      if (slot == null) continue;
+      final int end = _slotStart[slot + 1];
+      for (int i = _slotStart[slot]; i < end; i++) {
+        distanceChecks++;
+        visit(_owner[i], _lat[i], _lon[i]);
+      }
+    }
+  }
+
+  /// Distance to the closest point of the index, searched ring by ring
+  /// outwards from the position; [maxMeters] if nothing is that close.
+  /// Used for pacing GPS fixes, so it stops at [maxMeters] rather than
+  /// scanning the whole country.
+  double nearestDistance(double lat, double lon, double maxMeters) {
+    final int row = (lat / _cellLat).floor();
+    final int col = (lon / _cellLon).floor();
+    // Halka k'daki her nokta en az (k - 1) hücre uzakta
+    final double cellMeters = min(cellSizeMeters,
+        _cellLon * _metersPerDegreeLat * _safeCos(lat.abs()));
+    double best = maxMeters;
+    for (int ring = 0; (ring - 1) * cellMeters <= best; ring++) {
+      forEachRingCell(row, col, ring, (key) {
+        final int? slot = _cellSlot[key];
+        if (slot == null) return;
+        final int end = _slotStart[slot + 1];
+        for (int i = _slotStart[slot]; i < end; i++) {
+          distanceChecks++;
+          best = min(best, haversineMeters(lat, lon, _lat[i], _lon[i]));
+        }
+      });
+    }
+    return best;
+  }
+
+  void _forEachCandidate(
+    double lat,
+    double lon,
+    double radiusMeters,
+    void Function(int point) visit,
+  ) {
+    final double dLat = radiusMeters / _metersPerDegreeLat;
+    final double dLon =
+        radiusMeters / (_metersPerDegreeLat * _safeCos(lat.abs() + dLat));
+
+    final int rowMin = ((lat - dLat) / _cellLat).floor();
+    final int rowMax = ((lat + dLat) / _cellLat).floor();
+    final int colMin = ((lon - dLon) / _cellLon).floor();
+    final int colMax = ((lon + dLon) / _cellLon).floor();
+
+    for (int row = rowMin; row <= rowMax; row++) {
+      for (int col = colMin; col <= colMax; col++) {
+        final int? slot = _cellSlot[_key(row, col)];
+        if (slot == null) continue;
+
+        final int end = _slotStart[slot + 1];
+        for (int i = _slotStart[slot]; i < end; i++) {
+          visit(i);
+        }
+      }
+    }
+  }
+
+  void _visit(
+    int i,
+    double lat,
+    double lon,
+    double radiusMeters,
+    Map<int, double> nearest,
+  ) {
+    distanceChecks++;
+    final double distance = haversineMeters(lat, lon, _lat[i], _lon[i]);
+    if (distance > radiusMeters) return;
+
+    final int street = _owner[i];
+    final double? best = nearest[street];
+    if (best == null || distance < best) {
+      nearest[street] = distance;
+    }
+  }
+
+  static List<RiskIndexHit> _sortedHits(Map<int, double> nearest) {
+    final List<RiskIndexHit> hits = [
+      for (final entry in nearest.entries)
+        RiskIndexHit(entry.key, entry.value),
+    ];
+    hits.sort((a, b) => a.distance.compareTo(b.distance));
+    return hits;
+  }
+}
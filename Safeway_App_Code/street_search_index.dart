@@ -0,0 +1,238 @@
+import 'dart:typed_data';
+
+// Lithuanian letters first, then the neighbours' that show up in names.
+const Map<int, int> _foldTable = {
+  0x0105: 0x61, // ą
+  0x010D: 0x63, // č
+  0x0119: 0x65, // ę
+  0x0117: 0x65, // ė
+  0x012F: 0x69, // į
+  0x0161: 0x73, // š
+  0x0173: 0x75, // ų
+  0x016B: 0x75, // ū
+  0x017E: 0x7A, // ž
+  0x00E4: 0x61, // ä
+  0x00F6: 0x6F, // ö
+  0x00FC: 0x75, // ü
+  0x00F3: 0x6F, // ó
+  0x0142: 0x6C, // ł
+  0x0144: 0x6E, // ń
+  0x015B: 0x73, // ś
+  0x017A: 0x7A, // ź
+  0x017C: 0x7A, // ż
+  0x0107: 0x63, // ć
+  0x00E7: 0x63, // ç
+  0x015F: 0x73, // ş
+  0x011F: 0x67, // ğ
+  0x0131: 0x69, // ı
+};
+
+/// Lower case without diacritics: "Žalgirio g." -> "zalgirio g.".
+String foldDiacritics(String text) {
+  final String lower = text.toLowerCase();
+  final List<int> out = [];
+  for (final int unit in lower.codeUnits) {
+    // Birleşik aksan işaretlerini (ör. "İ" -> "i̇") at
+    if (unit >= 0x0300 && unit <= 0x036F) continue;
+    out.add(_foldTable[unit] ?? unit);
+  }
+  return String.fromCharCodes(out);
+}
+
+bool _isWordChar(int unit) =>
+    (unit >= 0x61 && unit <= 0x7A) ||
+    (unit >= 0x30 && unit <= 0x39) ||
+    unit > 0x7F;
+
+bool _startsWord(String text, String query) {
+  int at = text.indexOf(query);
+  while (at >= 0) {
+    if (at == 0 || !_isWordChar(text.codeUnitAt(at - 1))) return true;
+    at = text.indexOf(query, at + 1);
+  }
+  return false;
+}
+
+/// Rank of a match of folded [query] against folded [street] / [city],
+/// lower is better, or -1 for no match:
+/// 0 street starts with it, 1 a street word does, 2 a city word does,
+/// 3 it is somewhere inside either name.
+int matchTier(String street, String city, String query) {
+  if (street.startsWith(query)) return 0;
+  if (_startsWord(street, query)) return 1;
+  if (_startsWord(city, query)) return 2;
+  if (street.contains(query) || city.contains(query)) return 3;
+  return -1;
+}
+
+/// Autocomplete index over the explore page's streets.
+///
+/// Built once at load. A query returns at most [maxResults] entry indices,
+/// ranked by [matchTier] and then by entry order (the explore page sorts
+/// by accident count, so busier streets come first).
+///
+/// Single-word queries are answered from a prefix index: every word of
+/// every name, folded and sorted, which is a flattened trie where a prefix
+/// is one binary search and a contiguous range. That covers tiers 0-2; the
+/// trigram index is only consulted when those give fewer than
+/// [maxResults] hits, or for queries with spaces or punctuation. Trigram
+/// postings are intersected rarest first and the survivors verified, since
+/// sharing trigrams does not imply containing the query.
+class StreetSearchIndex {
+  final int maxResults;
+
+  final List<String> _streets;
+  final List<String> _cities;
+
+  /// Folded words, sorted, with the entry each came from.
+  final List<String> _words;
+  final Int32List _wordOwners;
+
+  final Map<int, Int32List> _trigrams;
+
+  StreetSearchIndex._(
+    this.maxResults,
+    this._streets,
+    this._cities,
+    this._words,
+    this._wordOwners,
+    this._trigrams,
+  );
+
+  factory StreetSearchIndex.build(
+    List<String> streets,
+    List<String> cities, {
+    int maxResults = 20,
+  }) {
+    final List<String> foldedStreets = [for (final s in streets) foldDiacritics(s)];
+    final List<String> foldedCities = [for (final c in cities) foldDiacritics(c)];
+
+    final List<MapEntry<String, int>> words = [];
+    final Map<int, List<int>> postings = {};
+    for (int i = 0; i < foldedStreets.length; i++) {
+      for (final text in [foldedStreets[i], foldedCities[i]]) {
+        for (final word in _splitWords(text)) {
+          words.add(MapEntry(word, i));
+        }
+        for (int p = 0; p + 3 <= text.length; p++) {
+          final List<int> list =
+              postings.putIfAbsent(_trigramAt(text, p), () => <int>[]);
+          // Entry'ler sırayla geliyor, tekrarı son elemana bakarak ele
+          if (list.isEmpty || list.last != i) list.add(i);
+        }
+      }
+    }
+    words.sort((a, b) {
+      final int byWord = a.key.compareTo(b.key);
+      return byWord != 0 ? byWord : a.value.compareTo(b.value);
+    });
+
+    return StreetSearchIndex._(
+      maxResults,
+      foldedStreets,
+      foldedCities,
+      [for (final w in words) w.key],
+      Int32List.fromList([for (final w in words) w.value]),
+      {
+        for (final e in postings.entries) e.key: Int32List.fromList(e.value),
+      },
+    );
+  }
+
+  int get length => _streets.length;
+
+  /// Indices of the best matches, best first. Empty for queries shorter
+  /// than three characters.
+  List<int> search(String rawQuery) {
+    final String query = foldDiacritics(rawQuery.trim());
+    if (query.length < 3) return const [];
+
+    // entry -> tier, only the best tier per entry is kept
+    final Map<int, int> hits = {};
+    final bool singleWord = query.codeUnits.every(_isWordChar);
+    if (singleWord) {
+      int at = _lowerBound(query);
+      while (at < _words.length && _words[at].startsWith(query)) {
+        final int entry = _wordOwners[at++];
+        hits.putIfAbsent(
+            entry, () => matchTier(_streets[entry], _cities[entry], query));
+      }
+    }
+    if (!singleWord || hits.length < maxResults) {
+      for (final int entry in _trigramCandidates(query)) {
+        if (hits.containsKey(entry)) continue;
+        final int tier = matchTier(_streets[entry], _cities[entry], query);
+        if (tier >= 0) hits[entry] = tier;
+      }
+    }
+
+    final List<int> keys = [
+      for (final e in hits.entries) e.value * length + e.key,
+    ]..sort();
+    return [
+      for (int k = 0; k < keys.length && k < maxResults; k++) keys[k] % length,
+    ];
+  }
+
+  int _lowerBound(String query) {
+    int lo = 0, hi = _words.length;
+    while (lo < hi) {
+      final int mid = (lo + hi) >> 1;
+      if (_words[mid].compareTo(query) < 0) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  Iterable<int> _trigramCandidates(String query) sync* {
+    final List<Int32List> lists = [];
+    for (int p = 0; p + 3 <= query.length; p++) {
+      final Int32List? list = _trigrams[_trigramAt(query, p)];
+      if (list == null) return;
+      lists.add(list);
+    }
+    lists.sort((a, b) => a.length.compareTo(b.length));
+    final Int32List rarest = lists.first;
+    for (final int entry in rarest) {
+      bool inAll = true;
+      for (int l = 1; l < lists.length && inAll; l++) {
+        inAll = _contains(lists[l], entry);
+      }
+      if (inAll) yield entry;
+    }
+  }
+
+  static bool _contains(Int32List sorted, int value) {
+    int lo = 0, hi = sorted.length;
+    while (lo < hi) {
+      final int mid = (lo + hi) >> 1;
+      if (sorted[mid] < value) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo < sorted.length && sorted[lo] == value;
+  }
+
+  static int _trigramAt(String text, int p) =>
+      (text.codeUnitAt(p) << 32) |
+      (text.codeUnitAt(p + 1) << 16) |
+      text.codeUnitAt(p + 2);
+
+  static Iterable<String> _splitWords(String text) sync* {
+    int start = -1;
+    for (int i = 0; i <= text.length; i++) {
+      final bool word = i < text.length && _isWordChar(text.codeUnitAt(i));
+      if (word && start < 0) {
+        start = i;
+      } else if (!word && start >= 0) {
+        yield text.substring(start, i);
+        start = -1;
+      }
+    }
+  }
+}
@@ -0,0 +1,132 @@
+import 'package:safewayproject/risk_spatial_index.dart';
+
+/// GPS accuracy tiers the scheduler picks from; the home page maps them to
+/// geolocator's `LocationAccuracy`.
+enum TrackingAccuracy { low, medium, high }
+
+/// One way of running the position stream.
+class TrackingProfile {
+  final String name;
+  final TrackingAccuracy accuracy;
+
+  /// Metres the device has to move before the next fix is delivered.
+  final int distanceFilter;
+
+  /// The profile is used while the effective clearance (see
+  /// [TrackingScheduler]) is below this many metres.
+  final double belowMeters;
+
+  const TrackingProfile(
+    this.name,
+    this.accuracy,
+    this.distanceFilter,
+    this.belowMeters,
+  );
+
+  @override
+  String toString() => '$name(${accuracy.name}, ${distanceFilter}m)';
+}
+
+/// Picks GPS accuracy and distance filter from how far the nearest risky
+/// street is.
+///
+/// The worker reports the clearance (distance to the closest indexed point
+/// or road stretch) each time it rebuilds its candidate set. Until the next
+/// report the scheduler works with a lower bound of it:
+///
+///   clearance - distance moved since the report - speed * [leadSeconds]
+///   - reported accuracy
+///
+/// so moving faster, or getting a worse fix, tightens the profile before
+/// the hotspot is reached. Tightening takes effect on the fix that calls
+/// for it; relaxing waits until the bound clears the next threshold by
+/// [relaxMargin], so a user hovering at a boundary does not restart the
+/// position stream on every fix.
+class TrackingScheduler {
+  /// Tightest first. The first one is the old fixed setting and is also
+  /// used while alerts are active or no clearance is known yet.
+  static const List<TrackingProfile> profiles = [
+    TrackingProfile('hotspot', TrackingAccuracy.high, 10, 300),
+    TrackingProfile('approach', TrackingAccuracy.high, 25, 1000),
+    TrackingProfile('cruise', TrackingAccuracy.medium, 50, 3000),
+    TrackingProfile('remote', TrackingAccuracy.low, 150, double.infinity),
+  ];
+
+  /// Clearances are not searched beyond this; anything further is
+  /// "remote" anyway.
+  static const double maxClearanceMeters = 5000;
+
+  final double leadSeconds;
+  final double relaxMargin;
+
+  double? _refLat;
+  double? _refLon;
+  double _clearance = 0;
+  int _tier = 0;
+
+  /// Number of profile switches so far, for the replay harness.
+  int switches = 0;
+
+  TrackingScheduler({this.leadSeconds = 60, this.relaxMargin = 1.25});
+
+  TrackingProfile get profile => profiles[_tier];
+
+  /// Latest clearance from the worker, measured at (refLat, refLon).
+  void updateClearance(double refLat, double refLon, double meters) {
+    _refLat = refLat;
+    _refLon = refLon;
+    _clearance = meters;
+  }
+
+  /// Feeds a fix; returns the new profile when the position stream should
+  /// be restarted with it, null otherwise. [speed] and [accuracy] are what
+  /// geolocator reports (negative when unknown).
+  TrackingProfile? onFix(
+    double lat,
+    double lon, {
+    double speed = 0,
+    double accuracy = 0,
+    bool alertsActive = false,
+  }) {
+    final int tier =
+        alertsActive ? 0 : _tierFor(_bound(lat, lon, speed, accuracy));
+    if (tier == _tier) return null;
+    _tier = tier;
+    switches++;
+    return profile;
+  }
+
+  /// Back to the tight profile with no clearance, e.g. when tracking stops.
+  void reset() {
+    _refLat = null;
+    _refLon = null;
+    _clearance = 0;
+    _tier = 0;
+  }
+
+  double _bound(double lat, double lon, double speed, double accuracy) {
+    final double? refLat = _refLat;
+    final double? refLon = _refLon;
+    if (refLat == null || refLon == null) return 0;
+    return _clearance -
+        haversineMeters(refLat, refLon, lat, lon) -
+        (speed > 0 ? speed : 0) * leadSeconds -
+        (accuracy > 0 ? accuracy : 0);
+  }
+
+  int _tierFor(double bound) {
+    int tier = 0;
+    while (bound >= profiles[tier].belowMeters) {
+      tier++;
+    }
+    if (tier <= _tier) return tier;
+
+    // Gevşetme için eşiği payla birlikte geçmiş olmalı
+    int relaxed = _tier;
+    while (relaxed < tier &&
+        bound >= profiles[relaxed].belowMeters * relaxMargin) {
+      relaxed++;
+    }
+    return relaxed;
+  }
+}
@@ -0,0 +1,115 @@
+# Data-loading wall clock of a full figure + pipeline regeneration, before
+# and after the Parquet store (code/accident_store.py).
+#
+#   python benchmark/accident_store_benchmark.py [--rows 75000]
+#
+# "before" replays the pd.read_excel calls the scripts made (Fig.1, Fig.11,
+# Fig.3-5 on the raw export; Fig.2, Fig.7-9, Fig.15, Fig.16 and scripts 3
+# and 4 on kaza_adresli.xlsx). "after" replays their load() calls, once
+# with a cold store (ingest included) and once with the store in place.
+# Each script runs in its own process, as it does in practice. Plotting is
+# not timed: it is the same on both sides.
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+CODE_DIR = Path(__file__).resolve().parent.parent / "code"
+
+RAW = "2020-2024m_EI-duomenys_viesinama.xlsx"
+ADDRESSED = "kaza_adresli.xlsx"
+
+BEFORE = [
+    f"pd.read_excel({RAW!r}, sheet_name='2020-2024')",   # Fig.1
+    f"pd.read_excel({RAW!r}, sheet_name='2020-2024')",   # Fig.11
+    f"pd.read_excel({RAW!r})",                           # Fig.3-5
+] + [f"pd.read_excel({ADDRESSED!r})"] * 6                # Fig.2/7-9/15/16, scripts 3/4
+
+_ADDRESSED_COLUMNS = '["Metai", "address", "Latitude", "Longitude"]'
+AFTER = [
+    "load('raw', columns=['Laikas'])",
+    "load('raw', columns=['Metai', 'Laikas'], years=[2024])",
+    "load('raw', columns=['Metai', 'Platuma', 'Ilguma', "
+    "'Administracinis teritorinis vienetas'], years=[2024], "
+    "municipality=lambda m: any(k in m.lower() for k in ('vilni', 'kaun', 'klaip')))",
+    "load('addressed', columns=['Metai', 'address'])",
+    f"load('addressed', columns={_ADDRESSED_COLUMNS})",
+    "load('addressed', columns=['Metai', 'address'])",
+    "load('addressed', columns=['Metai', 'address'])",
+    f"load('addressed', columns={_ADDRESSED_COLUMNS})",
+    f"load('addressed', columns={_ADDRESSED_COLUMNS})",
+]
+
+MUNICIPALITIES = [
+    "Vilniaus m. sav.", "Kauno m. sav.", "Klaipėdos m. sav.", "Šiaulių m. sav.",
+    "Panevėžio m. sav.", "Vilniaus r. sav.", "Kauno r. sav.", "Alytaus m. sav.",
+]
+CITIES = ["Vilnius", "Kaunas", "Klaipėda", "Šiauliai", "Panevėžys", "Alytus"]
+
+
+def make_workbooks(rows, seed=0):
+    rnd = np.random.default_rng(seed)
+    years = rnd.integers(2020, 2025, rows)
+    minutes = rnd.integers(0, 24 * 60, rows)
+    #  Older years as "HH:MM:SS" text, 2024 as Excel time numbers
+    laikas = [
+        m / 1440 if y == 2024 else f"{m // 60:02d}:{m % 60:02d}:00"
+        for y, m in zip(years, minutes)
+    ]
+    raw = pd.DataFrame({
+        "Metai": years,
+        "Laikas": laikas,
+        "Administracinis teritorinis vienetas": rnd.choice(MUNICIPALITIES, rows),
+        "Platuma": [f"{v:.2f}".replace(".", ",") for v in rnd.uniform(3e5, 6.8e5, rows)],
+        "Ilguma": [f"{v:.2f}".replace(".", ",") for v in rnd.uniform(5.98e6, 6.26e6, rows)],
+        "Eismo įvykio rūšis": rnd.choice(["Susidūrimas", "Pėsčiojo partrenkimas", "Kita"], rows),
+        "Žuvo": rnd.integers(0, 2, rows),
+        "Sužeista": rnd.integers(0, 4, rows),
+    })
+    raw.to_excel(RAW, sheet_name="2020-2024", index=False)
+
+    addressed = raw.copy()
+    addressed["Latitude"] = rnd.uniform(53.9, 56.4, rows)
+    addressed["Longitude"] = rnd.uniform(21.0, 26.8, rows)
+    addressed["address"] = [
+        f"{rnd.integers(1, 200)}, Gatvės {rnd.integers(1, 900)} g., {c}, Lithuania"
+        for c in rnd.choice(CITIES, rows)
+    ]
+    addressed.to_excel(ADDRESSED, index=False)
+
+
+def run_scripts(prelude, calls):
+    start = time.perf_counter()
+    for call in calls:
+        subprocess.run([sys.executable, "-c", f"{prelude}\ndf = {call}"], check=True)
+    return time.perf_counter() - start
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--rows", type=int, default=75_000)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        os.chdir(tmp)
+        make_workbooks(args.rows)
+        print(f"{args.rows} rows per workbook, {len(BEFORE)} script reads")
+
+        before = run_scripts("import pandas as pd", BEFORE)
+        print(f"before (read_excel)       {before:8.2f} s")
+
+        prelude = f"import sys; sys.path.insert(0, {str(CODE_DIR)!r})\nfrom accident_store import load"
+        cold = run_scripts(prelude, AFTER)
+        print(f"after, cold store         {cold:8.2f} s  (includes one-time ingest)")
+        warm = run_scripts(prelude, AFTER)
+        print(f"after, store in place     {warm:8.2f} s  (x{before / warm:.0f})")
+
+
+if __name__ == "__main__":
+    main()
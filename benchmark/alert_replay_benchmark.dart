@@ -0,0 +1,295 @@
+// Headless replay of the alert path (RiskAlertEngine + RiskNotificationPolicy,
+// exactly what the worker and the home page run) against a brute-force
+// reference. Meant as the regression gate for changes to matching.
+//
+//   dart run benchmark/alert_replay_benchmark.dart \
+//       [--map City_Level_Street_Risk.bin] [--max-p99-us 50] \
+//       [--min-recall 1] [--min-precision 1] [trace.gpx|trace.csv ...]
+//
+// Every trace point is one fix; heading comes from the next point and speed
+// from the trace timing. Without --map a synthetic map is encoded (20000
+// cluster centres, a third of the streets with road stretches); without
+// traces, ten 10 m-step drives are used.
+//
+// Reported:
+// - p50 / p99 / max latency of RiskAlertEngine.update per fix
+// - memory: RSS growth over the replay (the VM has no allocation counter
+//   outside the service protocol; run with --observe and take an
+//   allocation profile in DevTools for object counts)
+// - alert precision / recall: per fix, the engine's active set against
+//   every street within the radius by brute force over all centres and
+//   segments
+// - notification precision / recall per trace: streets notified (on entry
+//   or ahead) against low-risk-excluded streets the reference enters
+// - how many of those notices RiskDispatchQueue turns into platform calls
+//
+// Exits with status 1 when a --max-p99-us / --min-recall / --min-precision
+// bound is violated.
+import 'dart:io';
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:safewayproject/notification_dispatch_queue.dart';
+import 'package:safewayproject/risk_alert_engine.dart';
+import 'package:safewayproject/risk_map.dart';
+import 'package:safewayproject/risk_map_writer.dart';
+import 'package:safewayproject/risk_spatial_index.dart';
+
+import 'synthetic_risk_data.dart';
+import 'trace_reader.dart';
+
+const double _radius = 120.0;
+const double _degLat = earthRadiusMeters * pi / 180;
+
+RiskMap _syntheticMap(Random rnd) {
+  final streets = generateStreets(20000, rnd);
+  final entries = <RiskMapEntry>[];
+  for (int i = 0; i < streets.length; i++) {
+    final s = streets[i];
+    final double roll = rnd.nextDouble();
+    entries.add(RiskMapEntry(
+      city: 'City${i % cityCentres.length}',
+      street: 'Street $i',
+      riskLevel: roll < 0.2
+          ? RiskLevel.high
+          : (roll < 0.6 ? RiskLevel.medium : RiskLevel.low),
+      zScore: 0,
+      totalAccidents: 1 + rnd.nextInt(40),
+      clusterCount: s.lats.length,
+      latitudes: s.lats,
+      longitudes: s.lons,
+      segments: s.lats.length >= 2 && rnd.nextDouble() < 0.33
+          ? [RiskPolyline(s.lats, s.lons)]
+          : const [],
+      // Çoğu sokağın saat dilimi seviyesi var; 0 = tüm gün seviyesi
+      slotLevels: rnd.nextDouble() < 0.7
+          ? [for (int k = 0; k < RiskMap.slotCount; k++) rnd.nextInt(4)]
+          : null,
+    ));
+  }
+  final Uint8List bytes = encodeRiskMap(entries);
+  return RiskMap.fromByteData(ByteData.sublistView(bytes));
+}
+
+/// Every street within the radius, the slow way: all centres of streets
+/// without geometry, all segments of the rest.
+class _Reference {
+  final RiskMap riskMap;
+
+  _Reference(this.riskMap);
+
+  Set<int> within(double lat, double lon) {
+    final store = riskMap.coordinates;
+    final geometry = riskMap.segments;
+    final double kx = _degLat * cos(lat * pi / 180);
+    final double dLat = 1.01 * _radius / _degLat;
+    final Set<int> hits = {};
+    for (int s = 0; s < store.streetCount; s++) {
+      if (geometry.hasSegments(s)) {
+        for (int p = geometry.streetOffsets[s];
+            p < geometry.streetOffsets[s + 1];
+            p++) {
+          for (int v = geometry.polylineOffsets[p];
+              v + 1 < geometry.polylineOffsets[p + 1];
+              v++) {
+            final double ax = (geometry.longitudes[v] - lon) * kx;
+            final double ay = (geometry.latitudes[v] - lat) * _degLat;
+            final double dx = (geometry.longitudes[v + 1] - lon) * kx - ax;
+            final double dy = (geometry.latitudes[v + 1] - lat) * _degLat - ay;
+            final double len2 = dx * dx + dy * dy;
+            final double t = len2 > 0
+                ? (-(ax * dx + ay * dy) / len2).clamp(0.0, 1.0)
+                : 0.0;
+            final double px = ax + t * dx, py = ay + t * dy;
+            if (px * px + py * py <= _radius * _radius) hits.add(s);
+          }
+        }
+      } else {
+        for (int p = store.start(s); p < store.start(s + 1); p++) {
+          // Enlem farkı tek başına yarıçapı aşıyorsa haversine'e gerek yok
+          if ((store.latitudes[p] - lat).abs() > dLat) continue;
+          if (haversineMeters(
+                  lat, lon, store.latitudes[p], store.longitudes[p]) <=
+              _radius) {
+            hits.add(s);
+          }
+        }
+      }
+    }
+    return hits;
+  }
+}
+
+double _bearing(TraceFix from, TraceFix to) {
+  final double dLon = (to.lon - from.lon) * pi / 180;
+  final double lat1 = from.lat * pi / 180, lat2 = to.lat * pi / 180;
+  final double y = sin(dLon) * cos(lat2);
+  final double x = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(dLon);
+  return (atan2(y, x) * 180 / pi + 360) % 360;
+}
+
+List<TraceFix> _syntheticTrace(Random rnd) {
+  final drive = generateDrive(rnd, fixes: 1000);
+  return [
+    for (int t = 0; t < drive.length; t++)
+      TraceFix(drive[t][0], drive[t][1], t.toDouble(), 10),
+  ];
+}
+
+double _percentile(List<double> sorted, double q) => sorted.isEmpty
+    ? 0
+    : sorted[min(sorted.length - 1, (q * sorted.length).floor())];
+
+void main(List<String> args) {
+  final rnd = Random(19);
+  String? mapPath;
+  double? maxP99;
+  double minRecall = 1, minPrecision = 1;
+  final List<String> paths = [];
+  for (int i = 0; i < args.length; i++) {
+    switch (args[i]) {
+      case '--map':
+        mapPath = args[++i];
+        break;
+      case '--max-p99-us':
+        maxP99 = double.parse(args[++i]);
+        break;
+      case '--min-recall':
+        minRecall = double.parse(args[++i]);
+        break;
+      case '--min-precision':
+        minPrecision = double.parse(args[++i]);
+        break;
+      default:
+        paths.add(args[i]);
+    }
+  }
+
+  final RiskMap riskMap = mapPath != null
+      ? RiskMap.fromByteData(
+          ByteData.sublistView(File(mapPath).readAsBytesSync()))
+      : _syntheticMap(rnd);
+  final List<List<TraceFix>> traces = paths.isEmpty
+      ? [for (int i = 0; i < 10; i++) _syntheticTrace(rnd)]
+      : [for (final path in paths) readTrace(path)];
+
+  final engine = RiskAlertEngine.fromRiskMap(riskMap, radiusMeters: _radius);
+  final policy = RiskNotificationPolicy(riskMap);
+  final queue = RiskDispatchQueue();
+  final reference = _Reference(riskMap);
+
+  // Isınma: JIT ve index önbellekleri
+  for (final fix in traces.first.take(200)) {
+    engine.update(fix.lat, fix.lon);
+  }
+  engine.reset();
+
+  final List<double> latencies = [];
+  int tp = 0, fp = 0, fn = 0;
+  int noticeTp = 0, noticeFp = 0, noticeFn = 0;
+  final double tickMicros = 1e6 / Stopwatch().frequency;
+  final int rssBefore = ProcessInfo.currentRss;
+  final watch = Stopwatch();
+
+  for (final trace in traces) {
+    engine.reset();
+    policy.reset();
+    queue.clear();
+    final Set<int> notified = {};
+    final Set<int> shouldNotify = {};
+    DateTime now = DateTime(2024);
+
+    for (int f = 0; f < trace.length; f++) {
+      final TraceFix fix = trace[f];
+      final double heading =
+          f + 1 < trace.length ? _bearing(fix, trace[f + 1]) : -1;
+      if (f > 0) {
+        now = now.add(Duration(
+            milliseconds:
+                ((fix.seconds - trace[f - 1].seconds) * 1000).round()));
+      }
+
+      watch
+        ..reset()
+        ..start();
+      final RiskAlertDiff diff =
+          engine.update(fix.lat, fix.lon, speed: fix.speed, heading: heading);
+      watch.stop();
+      latencies.add(watch.elapsedTicks * tickMicros);
+
+      // Kuyruk penceresi doldu mu: simüle edilen saatle flush
+      final DateTime? windowEnd = queue.windowEnd;
+      if (windowEnd != null && !now.isBefore(windowEnd)) queue.flush(now);
+      for (final street in diff.removed) {
+        queue.retract(riskMap.id(street), now);
+      }
+      for (final notice in policy.onDiff(diff, now)) {
+        notified.add(notice.street);
+        queue.offer(
+          RiskNotificationRequest(
+            key: riskMap.id(notice.street),
+            streetName: riskMap.street(notice.street),
+            isHigh: notice.level == RiskLevel.high,
+            distanceMeters: notice.distanceMeters,
+            accidents: riskMap.totalAccidents(notice.street),
+            etaSeconds: notice.etaSeconds,
+          ),
+          now,
+        );
+      }
+
+      final Set<int> expected = reference.within(fix.lat, fix.lon);
+      final Set<int> actual = engine.active.keys.toSet();
+      tp += actual.intersection(expected).length;
+      fp += actual.difference(expected).length;
+      fn += expected.difference(actual).length;
+      for (final street in expected) {
+        if (riskMap.riskLevelAt(street, RiskMap.slotOf(now)) !=
+            RiskLevel.low) {
+          shouldNotify.add(street);
+        }
+      }
+    }
+    queue.flush(now);
+    noticeTp += notified.intersection(shouldNotify).length;
+    noticeFp += notified.difference(shouldNotify).length;
+    noticeFn += shouldNotify.difference(notified).length;
+  }
+  final int rssAfter = ProcessInfo.currentRss;
+
+  latencies.sort();
+  final double p50 = _percentile(latencies, 0.50);
+  final double p99 = _percentile(latencies, 0.99);
+  final double precision = tp + fp == 0 ? 1 : tp / (tp + fp);
+  final double recall = tp + fn == 0 ? 1 : tp / (tp + fn);
+  final double noticePrecision =
+      noticeTp + noticeFp == 0 ? 1 : noticeTp / (noticeTp + noticeFp);
+  final double noticeRecall =
+      noticeTp + noticeFn == 0 ? 1 : noticeTp / (noticeTp + noticeFn);
+
+  print('${riskMap.streetCount} streets, ${traces.length} traces, '
+      '${latencies.length} fixes, radius ${_radius.round()} m');
+  print('latency per fix: p50 ${p50.toStringAsFixed(1)} us | '
+      'p99 ${p99.toStringAsFixed(1)} us | '
+      'max ${latencies.isEmpty ? 0 : latencies.last.toStringAsFixed(1)} us');
+  print('RSS growth over replay: '
+      '${((rssAfter - rssBefore) / 1024).toStringAsFixed(0)} KiB');
+  print('alerts: precision ${precision.toStringAsFixed(4)} | '
+      'recall ${recall.toStringAsFixed(4)} ($tp tp, $fp fp, $fn fn)');
+  print('notifications: precision ${noticePrecision.toStringAsFixed(4)} | '
+      'recall ${noticeRecall.toStringAsFixed(4)} '
+      '($noticeTp tp, $noticeFp fp, $noticeFn fn)');
+  print('dispatch queue: ${queue.offered} notices -> '
+      '${queue.dispatched} platform notifications');
+
+  final List<String> failures = [
+    if (maxP99 != null && p99 > maxP99)
+      'p99 ${p99.toStringAsFixed(1)} us > $maxP99 us',
+    if (recall < minRecall) 'alert recall $recall < $minRecall',
+    if (precision < minPrecision) 'alert precision $precision < $minPrecision',
+  ];
+  if (failures.isNotEmpty) {
+    stderr.writeln('FAIL: ${failures.join('; ')}');
+    exitCode = 1;
+  }
+}
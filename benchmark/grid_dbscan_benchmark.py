@@ -0,0 +1,87 @@
+# code/grid_dbscan.py vs. sklearn.cluster.DBSCAN: wall clock and a
+# label-for-label comparison.
+#
+#   python benchmark/grid_dbscan_benchmark.py [--max-points 400000]
+#
+# Cases:
+# - the thesis cluster centres in data/ (what Fig.6 clusters), both as
+#   haversine 200 m and as EPSG:3857 metres with eps 600 m
+# - synthetic whole-country accident sets (hot spots around the cities
+#   plus background over Lithuania) of growing size, haversine 200 m
+import argparse
+import ast
+import sys
+import time
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+from sklearn.cluster import DBSCAN
+
+ROOT = Path(__file__).resolve().parent.parent
+sys.path.insert(0, str(ROOT / "code"))
+from grid_dbscan import grid_dbscan
+
+EARTH_RADIUS = 6371000
+CITY_CENTRES = np.array([[54.8985, 23.9036], [54.6872, 25.2797], [55.7033, 21.1443]])
+
+
+def thesis_points():
+    path = ROOT / "data" / "4 -k_k_v_accidents_data_lithuanian.xlsx"
+    df = pd.read_excel(path)
+    points = [p for v in df["Coordinate_Tuple"] for p in ast.literal_eval(v)]
+    return np.array(points, dtype=np.float64)
+
+
+def country_points(n, seed=0):
+    rnd = np.random.default_rng(seed)
+    city = rnd.random(n) < 0.7
+    centres = CITY_CENTRES[rnd.integers(0, 3, n)]
+    spots = centres + rnd.normal(0, [0.04, 0.07], (n, 2))
+    #  Accidents repeat at the same junctions
+    spots = np.round(spots / 0.002) * 0.002 + rnd.normal(0, 0.0006, (n, 2))
+    background = np.column_stack((rnd.uniform(53.9, 56.4, n), rnd.uniform(21.0, 26.8, n)))
+    return np.where(city[:, None], spots, background)
+
+
+def web_mercator(latlon):
+    x = np.radians(latlon[:, 1]) * 6378137.0
+    y = np.log(np.tan(np.pi / 4 + np.radians(latlon[:, 0]) / 2)) * 6378137.0
+    return np.column_stack((x, y))
+
+
+def compare(name, X, eps, min_samples, metric):
+    start = time.perf_counter()
+    expected = DBSCAN(eps=eps, min_samples=min_samples, metric=metric).fit_predict(X)
+    sk = time.perf_counter() - start
+    start = time.perf_counter()
+    labels = grid_dbscan(X, eps, min_samples, metric)
+    grid = time.perf_counter() - start
+    same = np.array_equal(labels, expected)
+    print(f"{name:<28} {len(X):>8} pts  sklearn {sk:7.3f} s  grid {grid:7.3f} s  "
+          f"x{sk / grid:5.1f}  {expected.max() + 1:>6} clusters  "
+          f"{'labels identical' if same else 'LABELS DIFFER'}")
+    return same
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--max-points", type=int, default=400_000)
+    args = parser.parse_args()
+
+    ok = True
+    thesis = thesis_points()
+    ok &= compare("thesis, haversine 200 m", np.radians(thesis), 200 / EARTH_RADIUS, 3, "haversine")
+    ok &= compare("thesis, EPSG:3857 600 m", web_mercator(thesis), 600.0, 3, "euclidean")
+
+    n = 10_000
+    while n <= args.max_points:
+        X = np.radians(country_points(n))
+        ok &= compare("country, haversine 200 m", X, 200 / EARTH_RADIUS, 3, "haversine")
+        n *= 4
+    if not ok:
+        raise SystemExit("labels differ from sklearn")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+// Replays synthetic 10 m-step drives against a full grid query per fix and
+// against IncrementalRiskSearch, and reports distance evaluations per fix,
+// CPU time per fix and how often the candidate set was rebuilt.
+//
+//   dart run benchmark/incremental_search_benchmark.dart
+import 'dart:math';
+
+import 'package:safewayproject/incremental_risk_search.dart';
+import 'package:safewayproject/risk_spatial_index.dart';
+
+import 'synthetic_risk_data.dart';
+
+const double _searchRadiusMeters = 120.0;
+const int _drives = 20;
+const int _fixesPerDrive = 2000;
+
+RiskSpatialIndex _buildIndex(List<SyntheticStreet> streets) {
+  final lats = <double>[];
+  final lons = <double>[];
+  final owners = <int>[];
+  for (int i = 0; i < streets.length; i++) {
+    lats.addAll(streets[i].lats);
+    lons.addAll(streets[i].lons);
+    owners.addAll(List.filled(streets[i].lats.length, i));
+  }
+  return RiskSpatialIndex.build(
+    lats,
+    lons,
+    owners,
+    cellSizeMeters: _searchRadiusMeters,
+  );
+}
+
+void _run(int centres, double prefetchMeters) {
+  final rnd = Random(centres);
+  final index = _buildIndex(generateStreets(centres, rnd));
+  final drives = [
+    for (int d = 0; d < _drives; d++)
+      generateDrive(rnd, fixes: _fixesPerDrive),
+  ];
+  final int fixes = _drives * _fixesPerDrive;
+
+  index.distanceChecks = 0;
+  final fullWatch = Stopwatch()..start();
+  final fullResults = <List<RiskIndexHit>>[];
+  for (final drive in drives) {
+    for (final fix in drive) {
+      fullResults.add(index.query(fix[0], fix[1], _searchRadiusMeters));
+    }
+  }
+  fullWatch.stop();
+  final int fullChecks = index.distanceChecks;
+
+  index.distanceChecks = 0;
+  int rebuilds = 0;
+  int mismatches = 0;
+  int f = 0;
+  final incrementalWatch = Stopwatch()..start();
+  for (final drive in drives) {
+    final search = IncrementalRiskSearch(
+      index,
+      radiusMeters: _searchRadiusMeters,
+      prefetchMeters: prefetchMeters,
+    );
+    for (final fix in drive) {
+      final hits = search.query(fix[0], fix[1]);
+      final expected = fullResults[f++];
+      if (hits.length != expected.length ||
+          !Iterable<int>.generate(hits.length).every(
+              (i) => hits[i].owner == expected[i].owner)) {
+        mismatches++;
+      }
+    }
+    rebuilds += search.rebuilds;
+  }
+  incrementalWatch.stop();
+  final int incrementalChecks = index.distanceChecks;
+
+  final fullUs = fullWatch.elapsedMicroseconds / fixes;
+  final incrementalUs = incrementalWatch.elapsedMicroseconds / fixes;
+  print('${centres.toString().padLeft(7)} centres, '
+      'prefetch ${prefetchMeters.toStringAsFixed(0).padLeft(4)} m | '
+      'full ${(fullChecks / fixes).toStringAsFixed(1).padLeft(6)} checks, '
+      '${fullUs.toStringAsFixed(1).padLeft(5)} us/fix | '
+      'incremental ${(incrementalChecks / fixes).toStringAsFixed(1).padLeft(6)} '
+      'checks, ${incrementalUs.toStringAsFixed(1).padLeft(5)} us/fix, '
+      'rebuild every ${(fixes / rebuilds).toStringAsFixed(1)} fixes | '
+      'CPU saved ${(100 * (1 - incrementalUs / fullUs)).toStringAsFixed(0)}%'
+      '${mismatches == 0 ? '' : ' | $mismatches MISMATCHES'}');
+}
+
+void main() {
+  for (final centres in [10000, 100000]) {
+    for (final prefetch in [200.0, 400.0, 800.0]) {
+      _run(centres, prefetch);
+    }
+  }
+}
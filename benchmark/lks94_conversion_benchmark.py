@@ -0,0 +1,95 @@
+# Per-point transformer loop (old script 1) vs. the chunked NumPy path in
+# code/lks94.py, in rows/second, plus a check that both give the same
+# coordinates.
+#
+#   python benchmark/lks94_conversion_benchmark.py [--rows 1000000]
+#
+# Points are synthetic LKS94 coordinates inside Lithuania, written with a
+# comma decimal separator like the police export.
+import argparse
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+from lks94 import X_COLUMN, Y_COLUMN, convert_file, convert_frame, get_transformer
+
+# LKS94 bounding box of Lithuania (easting, northing)
+_X_RANGE = (300_000, 680_000)
+_Y_RANGE = (5_980_000, 6_260_000)
+
+
+def synthetic_frame(rows, seed=0):
+    rnd = np.random.default_rng(seed)
+    x = rnd.uniform(*_X_RANGE, rows).round(2)
+    y = rnd.uniform(*_Y_RANGE, rows).round(2)
+    return pd.DataFrame({
+        "Metai": rnd.integers(2020, 2025, rows),
+        X_COLUMN: [f"{v:.2f}".replace(".", ",") for v in x],
+        Y_COLUMN: [f"{v:.2f}".replace(".", ",") for v in y],
+    })
+
+
+def per_point(df):
+    #  Same loop the script used before the batched path
+    transformer = get_transformer()
+    xs = df[X_COLUMN].astype(str).str.replace(",", ".").astype(float)
+    ys = df[Y_COLUMN].astype(str).str.replace(",", ".").astype(float)
+    longitudes, latitudes = [], []
+    for x, y in zip(xs, ys):
+        lon, lat = transformer.transform(x, y)
+        longitudes.append(lon)
+        latitudes.append(lat)
+    return np.array(longitudes), np.array(latitudes)
+
+
+def timed(fn):
+    start = time.perf_counter()
+    result = fn()
+    return result, time.perf_counter() - start
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--rows", type=int, default=1_000_000)
+    parser.add_argument("--per-point-rows", type=int, default=100_000,
+                        help="the old loop is slow, so it gets fewer rows")
+    parser.add_argument("--chunksize", type=int, default=200_000)
+    args = parser.parse_args()
+
+    df = synthetic_frame(args.rows)
+
+    sample = df.head(args.per_point_rows)
+    (ref_lon, ref_lat), t = timed(lambda: per_point(sample))
+    print(f"per-point loop   {len(sample) / t:>12,.0f} rows/s")
+
+    batched, t = timed(lambda: convert_frame(df))
+    print(f"batched (memory) {len(df) / t:>12,.0f} rows/s")
+
+    #  Correctness: identical to the per-point output
+    lon = batched["Longitude"].to_numpy()[:len(sample)]
+    lat = batched["Latitude"].to_numpy()[:len(sample)]
+    max_error = max(np.abs(lon - ref_lon).max(), np.abs(lat - ref_lat).max())
+    print(f"max |difference| vs per-point: {max_error:.3e} deg")
+    if max_error > 1e-9:
+        raise SystemExit("batched conversion differs from the per-point output")
+
+    with tempfile.TemporaryDirectory() as tmp:
+        source = Path(tmp) / "input.csv"
+        df.to_csv(source, index=False)
+        for workers in (1, 2, 4):
+            target = Path(tmp) / f"output_{workers}.csv"
+            rows, t = timed(lambda: convert_file(
+                source, target, chunksize=args.chunksize, workers=workers))
+            print(f"streamed CSV, {workers} worker(s) {rows / t:>12,.0f} rows/s")
+            streamed = pd.read_csv(target)
+            if not np.allclose(streamed["Latitude"], batched["Latitude"], rtol=0, atol=1e-9):
+                raise SystemExit(f"streamed output ({workers} workers) differs")
+
+
+if __name__ == "__main__":
+    main()
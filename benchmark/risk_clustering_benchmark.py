@@ -0,0 +1,82 @@
+# Per-street DBSCAN in code/risk_engine.py on 1..N processes, with a check
+# that every run writes a byte-identical CSV.
+#
+#   python benchmark/risk_clustering_benchmark.py [--rows 200000] [--max-workers 8]
+#
+# The accidents are synthetic: 60 municipalities of very different size,
+# Zipf-distributed streets inside each, so a few busy streets and many
+# 3-5 point ones, which is what the national data looks like.
+import argparse
+import io
+import os
+import sys
+import time
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+import risk_engine
+
+
+def synthetic_accidents(rows, municipalities=60, seed=0):
+    rnd = np.random.default_rng(seed)
+    weights = 1.0 / np.arange(1, municipalities + 1)
+    weights /= weights.sum()
+    muni = rnd.choice(municipalities, rows, p=weights)
+    street = rnd.zipf(1.5, rows) % 2000
+    centre_lat = 54.0 + (muni % 10) * 0.25
+    centre_lon = 21.5 + (muni // 10) * 0.9
+    #  Accidents spread along a ~3 km street, with junction-sized jitter
+    along = rnd.random(rows)
+    north = street % 2 == 0
+    lat = (centre_lat + (street % 50) * 0.004 + np.where(north, along * 0.027, 0)
+           + rnd.normal(0, 0.0002, rows))
+    lon = (centre_lon + (street // 50) * 0.006 + np.where(north, 0, along * 0.045)
+           + rnd.normal(0, 0.0002, rows))
+    address = [
+        f"{n}, Gatvė{s} g., Seniūnija, Savivaldybė{m} rajono savivaldybė, County, 00000, Lithuania"
+        for n, s, m in zip(rnd.integers(1, 200, rows), street, muni)
+    ]
+    #  Half of a street's accidents around its own rush hour, 3% untimed
+    peak = (street * 0.137) % 1.0
+    laikas = np.where(rnd.random(rows) < 0.5, (peak + rnd.normal(0, 0.05, rows)) % 1.0, rnd.random(rows))
+    laikas[rnd.random(rows) < 0.03] = np.nan
+    return pd.DataFrame({
+        "Metai": rnd.integers(2020, 2025, rows),
+        "Laikas": laikas,
+        "address": address,
+        "Latitude": lat,
+        "Longitude": lon,
+    })
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--rows", type=int, default=200_000)
+    parser.add_argument("--max-workers", type=int, default=os.cpu_count())
+    args = parser.parse_args()
+
+    df = synthetic_accidents(args.rows)
+    reference = None
+    serial = None
+    counts = sorted({1, args.max_workers} | {2 ** k for k in range(1, 8) if 2 ** k < args.max_workers})
+    for workers in counts:
+        start = time.perf_counter()
+        result = risk_engine.run(df, workers=workers)
+        elapsed = time.perf_counter() - start
+
+        buffer = io.StringIO()
+        result.to_csv(buffer, index=False)
+        if reference is None:
+            reference, serial = buffer.getvalue(), elapsed
+        elif buffer.getvalue() != reference:
+            raise SystemExit(f"output with {workers} workers differs from the serial run")
+
+        print(f"{workers:>3} worker(s) {elapsed:8.2f} s  x{serial / elapsed:4.1f}  "
+              f"({len(result)} risky streets)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,176 @@
+// Differential risk-map update against a local HTTP stand-in: bytes on the
+// wire for a delta vs. the full JSON / binary map, time to apply and
+// install it, and a byte-for-byte check of the installed map.
+//
+//   dart run benchmark/risk_delta_update_benchmark.dart [--centres 20000]
+//
+// The server is an in-process HttpServer on loopback that serves
+// risk_delta_v2.json and v3.json and 404s everything else, like
+// code/serve_risk_deltas.py does for a device.
+import 'dart:convert';
+import 'dart:io';
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:safewayproject/risk_map.dart';
+import 'package:safewayproject/risk_map_updater.dart';
+import 'package:safewayproject/risk_map_writer.dart';
+
+import 'synthetic_risk_data.dart';
+
+Map<String, dynamic> _record(RiskMapEntry e) => {
+      'City': e.city,
+      'Street': e.street,
+      'Risk_level': e.riskLevel.label,
+      'Z_score': e.zScore,
+      'Total_Cluster_Number_DBSCAN': e.clusterCount,
+      'Total_Accidents': e.totalAccidents,
+      'Coordinate_Tuple': [
+        for (int i = 0; i < e.latitudes.length; i++)
+          [e.latitudes[i], e.longitudes[i]],
+      ],
+    };
+
+RiskMapEntry _entry(String city, String street, Random rnd,
+    List<double> lats, List<double> lons) {
+  final double z = 0.5 + rnd.nextDouble() * 4;
+  return RiskMapEntry(
+    city: city,
+    street: street,
+    riskLevel: z > 2 ? RiskLevel.high : RiskLevel.medium,
+    // float32'de saklandığı için karşılaştırma da float32 üzerinden
+    zScore: Float32List.fromList([z])[0],
+    totalAccidents: 3 + rnd.nextInt(60),
+    clusterCount: lats.length,
+    latitudes: Float32List.fromList(lats),
+    longitudes: Float32List.fromList(lons),
+  );
+}
+
+int _compare(RiskMapEntry a, RiskMapEntry b) {
+  final int byCity = a.city.compareTo(b.city);
+  return byCity != 0 ? byCity : a.street.compareTo(b.street);
+}
+
+/// Changes ~1 % of the streets, removes ~0.5 % and adds ~0.5 %.
+Map<String, dynamic> _mutate(
+    List<RiskMapEntry> entries, int version, Random rnd) {
+  final upserts = <RiskMapEntry>[];
+  final removals = <String>[];
+  final Map<String, RiskMapEntry> byId = {for (final e in entries) e.id: e};
+  for (final e in List.of(entries)) {
+    final double roll = rnd.nextDouble();
+    if (roll < 0.005) {
+      removals.add(e.id);
+      byId.remove(e.id);
+    } else if (roll < 0.015) {
+      final changed = _entry(e.city, e.street, rnd, e.latitudes, e.longitudes);
+      upserts.add(changed);
+      byId[e.id] = changed;
+    }
+  }
+  for (final street in generateStreets(entries.length ~/ 100, rnd)) {
+    final added = _entry('Miestas${rnd.nextInt(60)}', 'Nauja g. $version-'
+        '${upserts.length}', rnd, street.lats, street.lons);
+    upserts.add(added);
+    byId[added.id] = added;
+  }
+  entries
+    ..clear()
+    ..addAll(byId.values)
+    ..sort(_compare);
+  return {
+    'format': 1,
+    'version': version,
+    'base_version': version - 1,
+    'upserts': [for (final e in upserts) _record(e)],
+    'removals': removals,
+  };
+}
+
+Future<void> main(List<String> args) async {
+  int centres = 20000;
+  final i = args.indexOf('--centres');
+  if (i >= 0 && i + 1 < args.length) centres = int.parse(args[i + 1]);
+
+  final rnd = Random(7);
+  final streets = generateStreets(centres, rnd);
+  final entries = <RiskMapEntry>[
+    for (int s = 0; s < streets.length; s++)
+      _entry('Miestas${s % 60}', 'Gatvė $s g.', rnd, streets[s].lats,
+          streets[s].lons),
+  ]..sort(_compare);
+
+  final Uint8List baseBytes = encodeRiskMap(entries);
+  final RiskMap base = RiskMap.fromByteData(ByteData.sublistView(baseBytes));
+  final int fullJson = utf8.encode(json.encode([
+    for (final e in entries) _record(e),
+  ])).length;
+
+  final Map<String, List<int>> files = {};
+  for (final version in [2, 3]) {
+    files['/risk_delta_v$version.json'] =
+        utf8.encode(json.encode(_mutate(entries, version, rnd)));
+  }
+  final Uint8List expected = encodeRiskMap(entries, dataVersion: 3);
+
+  final server = await HttpServer.bind(InternetAddress.loopbackIPv4, 0);
+  server.listen((request) {
+    final body = files[request.uri.path];
+    request.response.statusCode =
+        body == null ? HttpStatus.notFound : HttpStatus.ok;
+    if (body != null) request.response.add(body);
+    request.response.close();
+  });
+
+  final dir = await Directory.systemTemp.createTemp('risk_delta_');
+  try {
+    final updater = RiskMapUpdater(
+        dir, Uri.parse('http://127.0.0.1:${server.port}/'));
+    final watch = Stopwatch()..start();
+    final RiskMap? updated = await updater.update(() async => base);
+    watch.stop();
+
+    final int? version = await updater.installedVersion();
+    final installed = await File(
+            '${dir.path}/City_Level_Street_Risk.v$version.bin')
+        .readAsBytes();
+    final bool same = updated != null &&
+        version == 3 &&
+        installed.length == expected.length &&
+        _equal(installed, expected);
+    final bool idle = await updater.update(() async => base) == null;
+    // Daha yeni veriyle gelen bir uygulama sürümü kurulu haritayı geçer
+    final RiskMap shipped = RiskMap.fromByteData(
+        ByteData.sublistView(encodeRiskMap(entries, dataVersion: 4)));
+    final bool bundledWins = identical(
+        RiskMapUpdater.newest(await updater.readInstalled(), shipped),
+        shipped);
+    final int leftovers = dir.listSync().length;
+
+    print('${base.streetCount} streets, ${base.coordinates.pointCount} centres');
+    print('full JSON ${fullJson ~/ 1024} KiB | full binary '
+        '${baseBytes.length ~/ 1024} KiB | two deltas '
+        '${updater.downloadedBytes ~/ 1024} KiB over HTTP');
+    print('fetch + apply + install v2, v3: '
+        '${watch.elapsedMicroseconds / 1000} ms');
+    print(same
+        ? 'installed map identical to a fresh encode of the expected table'
+        : 'INSTALLED MAP DIFFERS');
+    print(idle ? 'second run: up to date' : 'SECOND RUN CHANGED SOMETHING');
+    print(bundledWins
+        ? 'bundled v4 preferred over installed v3'
+        : 'INSTALLED V3 SHADOWS BUNDLED V4');
+    if (!same || !idle || !bundledWins || leftovers != 1) exitCode = 1;
+  } finally {
+    await server.close(force: true);
+    await dir.delete(recursive: true);
+  }
+}
+
+bool _equal(List<int> a, List<int> b) {
+  for (int i = 0; i < a.length; i++) {
+    if (a[i] != b[i]) return false;
+  }
+  return true;
+}
@@ -0,0 +1,79 @@
+# Incremental risk-table update (code/risk_incremental.py) vs. a full
+# risk_engine rebuild, for growing batch sizes, and a check that
+# "old table + delta" equals the state's new table and agrees with the
+# full rebuild.
+#
+#   python benchmark/risk_incremental_benchmark.py [--rows 200000]
+#
+# History is 2020-2024 of the synthetic national set from
+# risk_clustering_benchmark.py; batches are a further year of it, 2025,
+# drawn with another seed.
+import argparse
+import shutil
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import risk_engine
+import risk_incremental
+from risk_clustering_benchmark import synthetic_accidents
+
+
+def check(old, delta, new, full):
+    applied = risk_incremental.apply_delta(old, delta)
+    pd.testing.assert_frame_equal(applied.reset_index(drop=True), new.reset_index(drop=True),
+                                  check_dtype=False)
+    a = full.set_index(["City", "Street"]).sort_index()
+    b = new.set_index(["City", "Street"]).sort_index()
+    if not a.index.equals(b.index):
+        raise SystemExit("incremental table has different streets than the full rebuild")
+    for col in ("Risk_level", "Total_Accidents", "Total_Cluster_Number_DBSCAN", "Coordinate_Tuple",
+                "Slot_risk_levels"):
+        if not (a[col].fillna("").to_numpy() == b[col].fillna("").to_numpy()).all():
+            raise SystemExit(f"{col} differs from the full rebuild")
+    return np.abs(a["Z_score"].to_numpy() - b["Z_score"].to_numpy()).max()
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--rows", type=int, default=200_000)
+    args = parser.parse_args()
+
+    history = synthetic_accidents(args.rows)
+    new_year = synthetic_accidents(args.rows // 5, seed=1).assign(Metai=2025)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        base = Path(tmp) / "base"
+        start = time.perf_counter()
+        risk_incremental.RiskState(base).init(history)
+        print(f"init from {len(history)} rows: {time.perf_counter() - start:.2f} s (once)")
+
+        for size in sorted({100, 1000, 10_000, len(new_year)}):
+            batch = new_year.head(size)
+            state_dir = Path(tmp) / f"state_{size}"
+            shutil.copytree(base, state_dir)
+            state = risk_incremental.RiskState(state_dir)
+            old = state.read_table()
+
+            start = time.perf_counter()
+            delta, new = state.update(batch)
+            incremental = time.perf_counter() - start
+
+            start = time.perf_counter()
+            full = risk_engine.run(pd.concat([history, batch]), years=risk_incremental.YEARS)
+            rebuild = time.perf_counter() - start
+
+            z_error = check(old, delta, new, full)
+            print(f"batch {size:>7} rows | update {incremental:6.2f} s | full rebuild "
+                  f"{rebuild:6.2f} s | {len(delta['upserts']):>5} upserts, "
+                  f"{len(delta['removals']):>4} removals | max |dz| {z_error:.4f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,123 @@
+// Route-ahead prefetch vs. the plain radius search, on synthetic drives at
+// highway speed: warning lead time, grid work per fix and ray reuse.
+//
+//   dart run benchmark/risk_lookahead_benchmark.dart
+//
+// Each drive is sampled once per second at [_speed] m/s; the heading of a
+// fix is the bearing to the next one (what geolocator reports while
+// driving). A street is "warned" at the first fix that either announces it
+// ahead (lookahead) or finds it inside the radius (circle search). The
+// other way to warn early without a course is a wider circle of radius
+// R + v * T; its grid work is printed for comparison.
+import 'dart:math';
+
+import 'package:safewayproject/risk_lookahead.dart';
+import 'package:safewayproject/risk_spatial_index.dart';
+
+import 'synthetic_risk_data.dart';
+
+const double _radius = 120.0;
+const double _speed = 30.0;
+const double _horizon = 30.0;
+const int _centres = 60000;
+const int _drives = 20;
+const int _fixesPerDrive = 600;
+
+double _bearing(List<double> from, List<double> to) {
+  final double dLon = (to[1] - from[1]) * pi / 180;
+  final double lat1 = from[0] * pi / 180, lat2 = to[0] * pi / 180;
+  final double y = sin(dLon) * cos(lat2);
+  final double x = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(dLon);
+  return (atan2(y, x) * 180 / pi + 360) % 360;
+}
+
+RiskSpatialIndex _buildIndex(List<SyntheticStreet> streets) {
+  final lats = <double>[], lons = <double>[], owners = <int>[];
+  for (int s = 0; s < streets.length; s++) {
+    lats.addAll(streets[s].lats);
+    lons.addAll(streets[s].lons);
+    owners.addAll(List.filled(streets[s].lats.length, s));
+  }
+  return RiskSpatialIndex.build(lats, lons, owners, cellSizeMeters: _radius);
+}
+
+void main() {
+  final rnd = Random(17);
+  final streets = generateStreets(_centres, rnd);
+
+  final circle = _buildIndex(streets);
+  final wide = _buildIndex(streets);
+  final corridor = _buildIndex(streets);
+  final lookahead = RiskLookahead(corridor, radiusMeters: _radius,
+      horizonSeconds: _horizon);
+
+  int fixes = 0;
+  int reached = 0;
+  int warnedEarly = 0;
+  int announced = 0;
+  int announcedReached = 0;
+  double leadSeconds = 0;
+  int circleMicros = 0, wideMicros = 0, lookaheadMicros = 0;
+
+  for (int d = 0; d < _drives; d++) {
+    final drive = generateDrive(rnd, fixes: _fixesPerDrive + 1,
+        stepMeters: _speed);
+    lookahead.reset();
+
+    final Map<int, int> firstAhead = {};
+    final Map<int, int> firstInside = {};
+    for (int f = 0; f < _fixesPerDrive; f++) {
+      fixes++;
+      final fix = drive[f];
+      final double heading = _bearing(fix, drive[f + 1]);
+
+      final watch = Stopwatch()..start();
+      final inside = circle.query(fix[0], fix[1], _radius);
+      circleMicros += watch.elapsedMicroseconds;
+
+      watch.reset();
+      wide.query(fix[0], fix[1], _radius + _speed * _horizon);
+      wideMicros += watch.elapsedMicroseconds;
+
+      watch.reset();
+      final ahead = lookahead.query(fix[0], fix[1], _speed, heading);
+      lookaheadMicros += watch.elapsedMicroseconds;
+
+      for (final hit in inside) {
+        firstInside.putIfAbsent(hit.owner, () => f);
+      }
+      for (final upcoming in ahead) {
+        firstAhead.putIfAbsent(upcoming.street, () => f);
+      }
+    }
+
+    announced += firstAhead.length;
+    for (final entry in firstInside.entries) {
+      reached++;
+      final int? early = firstAhead[entry.key];
+      if (early != null && early < entry.value) {
+        warnedEarly++;
+        leadSeconds += entry.value - early;
+      }
+    }
+    announcedReached +=
+        firstAhead.keys.where((s) => firstInside.containsKey(s)).length;
+  }
+
+  print('${streets.length} streets, $_drives drives at '
+      '${_speed.round()} m/s, $fixes fixes, radius ${_radius.round()} m, '
+      'horizon ${_horizon.round()} s');
+  print('streets reached: $reached, warned before the radius: $warnedEarly '
+      '(${(100 * warnedEarly / max(reached, 1)).toStringAsFixed(1)}%), '
+      'mean lead ${(leadSeconds / max(warnedEarly, 1)).toStringAsFixed(1)} s');
+  print('announced ahead: $announced, of which reached: $announcedReached '
+      '(${(100 * announcedReached / max(announced, 1)).toStringAsFixed(1)}%)');
+  print('circle R          | ${(circle.distanceChecks / fixes).toStringAsFixed(1)} '
+      'checks/fix | ${(circleMicros / fixes).toStringAsFixed(1)} us/fix');
+  print('circle R + v*T    | ${(wide.distanceChecks / fixes).toStringAsFixed(1)} '
+      'checks/fix | ${(wideMicros / fixes).toStringAsFixed(1)} us/fix');
+  print('lookahead         | ${(corridor.distanceChecks / fixes).toStringAsFixed(1)} '
+      'checks/fix | ${(lookaheadMicros / fixes).toStringAsFixed(1)} us/fix '
+      '| ray reused on '
+      '${(100 * (1 - lookahead.rebuilds / fixes)).toStringAsFixed(1)}% of fixes');
+}
@@ -0,0 +1,74 @@
+// Cold-start time and resident memory: JSON asset vs. binary risk map.
+//
+//   dart run benchmark/risk_map_load_benchmark.dart \
+//       City_Level_Street_Risk.json City_Level_Street_Risk.bin
+//
+// Each path runs in its own process so one does not warm up the other.
+// The JSON path is decoded twice because home and explore used to each keep
+// their own copy; the binary map is opened once and shared.
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:safewayproject/risk_coordinate_store.dart';
+import 'package:safewayproject/risk_map.dart';
+
+Future<void> main(List<String> args) async {
+  if (args.length == 3 && args[0] == '--child') {
+    _child(args[1], args[2]);
+    return;
+  }
+  if (args.length != 2) {
+    stderr.writeln('usage: risk_map_load_benchmark.dart <json> <bin>');
+    exitCode = 64;
+    return;
+  }
+
+  for (final mode in ['json', 'bin']) {
+    final path = mode == 'json' ? args[0] : args[1];
+    final result = await Process.run(
+      Platform.resolvedExecutable,
+      [Platform.script.toFilePath(), '--child', mode, path],
+    );
+    stdout.write(result.stdout);
+    stderr.write(result.stderr);
+  }
+}
+
+void _child(String mode, String path) {
+  final int rssBefore = ProcessInfo.currentRss;
+  final watch = Stopwatch()..start();
+  final retained = <Object>[];
+  int streets = 0;
+  int points = 0;
+
+  if (mode == 'json') {
+    for (int page = 0; page < 2; page++) {
+      final List<dynamic> data = json.decode(File(path).readAsStringSync());
+      final store = RiskCoordinateStore.fromRiskData(data);
+      retained..add(data)..add(store);
+      streets = data.length;
+      points = store.pointCount;
+    }
+  } else {
+    final Uint8List bytes = File(path).readAsBytesSync();
+    final riskMap = RiskMap.fromByteData(ByteData.sublistView(bytes));
+    // Touch every column once, like the explore page does.
+    for (int i = 0; i < riskMap.streetCount; i++) {
+      riskMap.city(i);
+      riskMap.street(i);
+      riskMap.totalAccidents(i);
+    }
+    retained.add(riskMap);
+    streets = riskMap.streetCount;
+    points = riskMap.coordinates.pointCount;
+  }
+
+  watch.stop();
+  final int rssAfter = ProcessInfo.currentRss;
+  print('${mode.padRight(4)} | ${File(path).lengthSync()} bytes on disk | '
+      '$streets streets, $points points | '
+      'load ${watch.elapsedMicroseconds / 1000} ms | '
+      'RSS +${((rssAfter - rssBefore) / 1024).round()} KiB '
+      '(${retained.length} objects kept)');
+}
@@ -0,0 +1,159 @@
+// Distance to the road vs. distance to stored points, on synthetic ~1 km
+// risky stretches: per-fix work, stored points and missed alerts.
+//
+//   dart run benchmark/risk_segment_index_benchmark.dart
+//
+// Three ways to represent the same streets:
+// - centroids: 1-4 DBSCAN-like centres per stretch (today's map)
+// - dense points: the stretch sampled every 25 m, which is what the point
+//   index would need to approximate the road
+// - segments: the snapped polyline itself, in a RiskSegmentIndex
+// A fix "should alert" for a street when the road stretch is within the
+// search radius; that truth is computed by brute force over all segments.
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:safewayproject/risk_segment_index.dart';
+import 'package:safewayproject/risk_spatial_index.dart';
+
+import 'synthetic_risk_data.dart';
+
+const double _radius = 120.0;
+const int _streets = 4000;
+const double _degLat = earthRadiusMeters * pi / 180;
+
+class _Variant {
+  final String name;
+  final int storedPoints;
+  final List<RiskIndexHit> Function(double lat, double lon) query;
+  final int Function() checks;
+  int micros = 0;
+  int missed = 0;
+
+  _Variant(this.name, this.storedPoints, this.query, this.checks);
+}
+
+double _segmentDistance(double lat, double lon, double aLat, double aLon,
+    double bLat, double bLon) {
+  final double kx = _degLat * cos(lat * pi / 180);
+  final double ax = (aLon - lon) * kx, ay = (aLat - lat) * _degLat;
+  final double dx = (bLon - lon) * kx - ax, dy = (bLat - lat) * _degLat - ay;
+  final double len2 = dx * dx + dy * dy;
+  final double t =
+      len2 > 0 ? (-(ax * dx + ay * dy) / len2).clamp(0.0, 1.0) : 0.0;
+  return sqrt(pow(ax + t * dx, 2) + pow(ay + t * dy, 2));
+}
+
+void main() {
+  final rnd = Random(11);
+
+  // Her sokak: 3-6 köşeli, ~1 km'lik hafif kıvrımlı bir yol parçası
+  final streetOffsets = Int32List(_streets + 1);
+  final polylineOffsets = Int32List(_streets + 1);
+  final vLat = <double>[], vLon = <double>[];
+  final cLat = <double>[], cLon = <double>[], cOwner = <int>[];
+  final dLat = <double>[], dLon = <double>[], dOwner = <int>[];
+  for (int s = 0; s < _streets; s++) {
+    final start = randomPoint(rnd);
+    double lat = start[0], lon = start[1];
+    double heading = rnd.nextDouble() * 2 * pi;
+    final int vertices = 3 + rnd.nextInt(4);
+    final int first = vLat.length;
+    for (int v = 0; v < vertices; v++) {
+      vLat.add(lat);
+      vLon.add(lon);
+      final double step = 1000 / (vertices - 1);
+      heading += gaussian(rnd) * 0.3;
+      lat += step * cos(heading) / _degLat;
+      lon += step * sin(heading) / (_degLat * cos(lat * pi / 180));
+    }
+    streetOffsets[s + 1] = s + 1;
+    polylineOffsets[s + 1] = vLat.length;
+
+    for (int c = 0, n = 1 + rnd.nextInt(4); c < n; c++) {
+      final int v = first + rnd.nextInt(vertices);
+      cLat.add(vLat[v]);
+      cLon.add(vLon[v]);
+      cOwner.add(s);
+    }
+    for (int v = first; v + 1 < vLat.length; v++) {
+      final double length =
+          haversineMeters(vLat[v], vLon[v], vLat[v + 1], vLon[v + 1]);
+      final int samples = max(1, (length / 25).ceil());
+      for (int k = 0; k < samples; k++) {
+        final double t = k / samples;
+        dLat.add(vLat[v] + t * (vLat[v + 1] - vLat[v]));
+        dLon.add(vLon[v] + t * (vLon[v + 1] - vLon[v]));
+        dOwner.add(s);
+      }
+    }
+    dLat.add(vLat.last);
+    dLon.add(vLon.last);
+    dOwner.add(s);
+  }
+
+  final store = RiskSegmentStore(streetOffsets, polylineOffsets,
+      Float32List.fromList(vLat), Float32List.fromList(vLon));
+  // Karşılaştırma float32 köşeler üzerinden, index ile aynı veri
+  final fLat = store.latitudes, fLon = store.longitudes;
+
+  final centroids =
+      RiskSpatialIndex.build(cLat, cLon, cOwner, cellSizeMeters: _radius);
+  final dense =
+      RiskSpatialIndex.build(dLat, dLon, dOwner, cellSizeMeters: _radius);
+  final segments = RiskSegmentIndex.build(store, cellSizeMeters: _radius);
+
+  final variants = [
+    _Variant('centroids', cLat.length, (a, b) => centroids.query(a, b, _radius),
+        () => centroids.distanceChecks),
+    _Variant('dense points', dLat.length, (a, b) => dense.query(a, b, _radius),
+        () => dense.distanceChecks),
+    _Variant('segments', vLat.length, (a, b) => segments.query(a, b, _radius),
+        () => segments.distanceChecks),
+  ];
+
+  int fixes = 0;
+  int expectedAlerts = 0;
+  double worstError = 0;
+  for (int d = 0; d < 5; d++) {
+    for (final fix in generateDrive(rnd, fixes: 1000)) {
+      fixes++;
+      final Map<int, double> truth = {};
+      for (int s = 0; s < _streets; s++) {
+        for (int v = polylineOffsets[s]; v + 1 < polylineOffsets[s + 1]; v++) {
+          final double dist = _segmentDistance(
+              fix[0], fix[1], fLat[v], fLon[v], fLat[v + 1], fLon[v + 1]);
+          if (dist <= _radius && dist < (truth[s] ?? double.infinity)) {
+            truth[s] = dist;
+          }
+        }
+      }
+      expectedAlerts += truth.length;
+
+      for (final variant in variants) {
+        final watch = Stopwatch()..start();
+        final hits = variant.query(fix[0], fix[1]);
+        watch.stop();
+        variant.micros += watch.elapsedMicroseconds;
+        final found = {for (final h in hits) h.owner: h.distance};
+        variant.missed += truth.keys.where((s) => !found.containsKey(s)).length;
+        if (variant.name == 'segments') {
+          for (final h in hits) {
+            worstError = max(worstError, (h.distance - (truth[h.owner] ?? h.distance)).abs());
+          }
+        }
+      }
+    }
+  }
+
+  print('$_streets stretches, $fixes fixes, $expectedAlerts street alerts '
+      'expected within ${_radius.round()} m of the road');
+  for (final v in variants) {
+    print('${v.name.padRight(12)} | ${v.storedPoints.toString().padLeft(7)} '
+        'stored points | ${(v.checks() / fixes).toStringAsFixed(1)} '
+        'distance checks/fix | ${(v.micros / fixes).toStringAsFixed(1)} us/fix '
+        '| ${v.missed} alerts missed');
+  }
+  print('segment index vs brute force: max distance difference '
+      '${worstError.toStringAsFixed(6)} m');
+}
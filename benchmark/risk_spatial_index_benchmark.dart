@@ -0,0 +1,113 @@
+// Grid index vs. the old linear scan of `_searchNearbyRisks`.
+//
+//   dart run benchmark/risk_spatial_index_benchmark.dart
+//
+// Cluster centres come from synthetic_risk_data.dart.
+import 'dart:math';
+
+import 'package:safewayproject/risk_spatial_index.dart';
+
+import 'synthetic_risk_data.dart';
+
+const double _searchRadiusMeters = 120.0;
+const int _queries = 2000;
+
+// Same parsing the home page does for every street on every fix.
+List<Map<String, double>> _parseCoordinates(String coordinateString) {
+  final cleaned = coordinateString
+      .replaceAll('[', '')
+      .replaceAll(']', '')
+      .replaceAll('(', '')
+      .replaceAll(')', '');
+  final pairs = cleaned.split(', ');
+  final List<Map<String, double>> coordinates = [];
+  for (int i = 0; i < pairs.length - 1; i += 2) {
+    final lat = double.tryParse(pairs[i].trim());
+    final lon = double.tryParse(pairs[i + 1].trim());
+    if (lat != null && lon != null) {
+      coordinates.add({'lat': lat, 'lon': lon});
+    }
+  }
+  return coordinates;
+}
+
+int _linearScan(List<SyntheticStreet> streets, double lat, double lon) {
+  int found = 0;
+  for (final street in streets) {
+    double minDistance = double.infinity;
+    for (final coord in _parseCoordinates(street.coordinateTuple)) {
+      final d = haversineMeters(lat, lon, coord['lat']!, coord['lon']!);
+      if (d < minDistance) minDistance = d;
+    }
+    if (minDistance <= _searchRadiusMeters) found++;
+  }
+  return found;
+}
+
+void _run(int centres) {
+  final rnd = Random(centres);
+  final streets = generateStreets(centres, rnd);
+
+  final buildWatch = Stopwatch()..start();
+  final lats = <double>[];
+  final lons = <double>[];
+  final owners = <int>[];
+  for (int i = 0; i < streets.length; i++) {
+    lats.addAll(streets[i].lats);
+    lons.addAll(streets[i].lons);
+    owners.addAll(List.filled(streets[i].lats.length, i));
+  }
+  final index = RiskSpatialIndex.build(
+    lats,
+    lons,
+    owners,
+    cellSizeMeters: _searchRadiusMeters,
+  );
+  buildWatch.stop();
+
+  final positions = List.generate(_queries, (_) => randomPoint(rnd));
+
+  // The linear scan is slow at 100k, so it gets fewer queries.
+  final int linearQueries = max(20, _queries * 1000 ~/ centres);
+  final linearWatch = Stopwatch()..start();
+  int linearHits = 0;
+  for (int q = 0; q < linearQueries; q++) {
+    linearHits += _linearScan(streets, positions[q][0], positions[q][1]);
+  }
+  linearWatch.stop();
+
+  final indexWatch = Stopwatch()..start();
+  int indexHits = 0;
+  for (int q = 0; q < _queries; q++) {
+    indexHits +=
+        index.query(positions[q][0], positions[q][1], _searchRadiusMeters)
+            .length;
+  }
+  indexWatch.stop();
+
+  // Sanity check: both paths must find the same streets.
+  int checkHits = 0;
+  for (int q = 0; q < linearQueries; q++) {
+    checkHits +=
+        index.query(positions[q][0], positions[q][1], _searchRadiusMeters)
+            .length;
+  }
+  if (checkHits != linearHits) {
+    throw StateError('index found $checkHits hits, linear scan $linearHits');
+  }
+
+  final linearUs = linearWatch.elapsedMicroseconds / linearQueries;
+  final indexUs = indexWatch.elapsedMicroseconds / _queries;
+  print('${centres.toString().padLeft(7)} centres | '
+      'build ${buildWatch.elapsedMilliseconds.toString().padLeft(5)} ms | '
+      'linear ${linearUs.toStringAsFixed(1).padLeft(10)} us/fix | '
+      'grid ${indexUs.toStringAsFixed(1).padLeft(7)} us/fix | '
+      'x${(linearUs / indexUs).toStringAsFixed(0)} '
+      '($indexHits hits)');
+}
+
+void main() {
+  for (final centres in [1000, 10000, 100000]) {
+    _run(centres);
+  }
+}
@@ -0,0 +1,150 @@
+# Street-name extraction as the scripts did it (regex + fallback row by row)
+# against code/street_normalizer.py with a cold and a warm on-disk cache,
+# plus a check that both give identical names for every row.
+#
+#   python benchmark/street_normalizer_benchmark.py [--rows 500000] [--unique 20000]
+#
+# The addresses are synthetic Nominatim strings drawn Zipf-like from a
+# pool of `--unique`, so busy junctions repeat thousands of times. The
+# pool mixes every shape the rules branch on: suffix found by the regex,
+# suffix only in a later comma part, lower/upper case suffixes, no suffix
+# at all, one-part addresses and missing values. Exits with status 1 on
+# any mismatch.
+import argparse
+import re
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+import street_normalizer
+
+# --- the per-row rules as they were copied into the scripts ---------------
+
+RISK_PATTERN = r'(\b[\wÀ-ž\s\-\.]+?\s?(g\.|pl\.|pr\.|kel\.|al\.|gatvė|prospektas|kelias|alėja))'
+
+
+def backup_street(parts, existing):
+    if existing != "Bilinmeyen":
+        return existing
+    for p in parts:
+        if re.search(r'\b(g\.|pl\.|pr\.|kel\.|al\.|gatvė|prospektas|kelias|alėja)\b', p.strip(), re.IGNORECASE):
+            return p.strip()
+    return parts[2].strip() if len(parts) >= 3 else "Bilinmeyen"
+
+
+def old_risk(addresses):
+    clean = addresses.str.extract(RISK_PATTERN, expand=False)[0].fillna("Bilinmeyen")
+    parts = addresses.str.split(",")
+    return np.array([backup_street(p, c) for p, c in zip(parts, clean)], dtype=object)
+
+
+def extract_street(addr):
+    if pd.isna(addr):
+        return None
+    addr = str(addr)
+    pattern = r"([\wÀ-ž\.\- ]+?\s(?:g\.|pl\.|pr\.|kel\.|al\.|gatvė|prospektas|kelias|alėja))"
+    m = re.search(pattern, addr)
+    if m:
+        return m.group(1).strip()
+    parts = addr.split(",")
+    if len(parts) > 1:
+        return parts[1].strip()
+    return addr.strip()
+
+
+def old_figure(addresses):
+    return addresses.apply(extract_street).to_numpy(dtype=object)
+
+
+# --------------------------------------------------------------------------
+
+NAMES = ["Taikos", "Šilutės", "Žalgirio", "Laisvės", "Savanorių", "Ukmergės", "Kalvarijų",
+         "Vytauto", "Gedimino", "Liepų", "Mėguvos", "Pilies", "Aušros", "Sodų"]
+SUFFIXES = ["g.", "pl.", "pr.", "kel.", "al.", "gatvė", "prospektas", "kelias", "alėja", "G.", "PR."]
+PLACES = ["Klaipėda", "Vilnius", "Kaunas", "Verebiejai", "Naujininkai", "Dainava"]
+MUNICIPALITIES = ["Klaipėdos miesto savivaldybė", "Vilniaus miesto savivaldybė",
+                  "Kauno rajono savivaldybė", "Vilnius city municipality", "Alytaus m. sav."]
+
+
+def synthetic_addresses(rows, unique, seed=0):
+    rnd = np.random.default_rng(seed)
+    pool = []
+    for i in range(unique):
+        name = f"{NAMES[i % len(NAMES)]}{'' if i < len(NAMES) else i // len(NAMES)}"
+        street = f"{name} {SUFFIXES[rnd.integers(len(SUFFIXES))]}"
+        place = PLACES[rnd.integers(len(PLACES))]
+        muni = MUNICIPALITIES[rnd.integers(len(MUNICIPALITIES))]
+        shape = rnd.integers(8)
+        if shape == 0:  # yalnızca sonraki parçada sonek (ör. "Kelias A1")
+            address = f"{rnd.integers(1, 200)}, {place}, Kelias {name}, {muni}, Lithuania"
+        elif shape == 1:  # hiç sonek yok
+            address = f"{place}, {name}, {muni}, 00000, Lithuania"
+        elif shape == 2:  # tek parça
+            address = f"{name} kaimas"
+        elif shape == 3:
+            address = f"{street} {rnd.integers(1, 200)}, {place}, {muni}, Lithuania"
+        else:
+            address = f"{rnd.integers(1, 200)}, {street}, {place}, {muni}, Lietuva"
+        pool.append(address)
+    pool.append(None)
+    weights = 1.0 / np.arange(1, len(pool) + 1)
+    weights /= weights.sum()
+    return pd.Series(np.array(pool, dtype=object)[rnd.choice(len(pool), rows, p=weights)], dtype=object)
+
+
+def _same(a, b):
+    # apply() None'ı NaN'a çevirebiliyor; ikisi de "sokak yok"
+    return a == b or (pd.isna(a) and pd.isna(b))
+
+
+def timed(fn):
+    start = time.perf_counter()
+    out = fn()
+    return out, time.perf_counter() - start
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--rows", type=int, default=500_000)
+    parser.add_argument("--unique", type=int, default=20_000)
+    args = parser.parse_args()
+
+    addresses = synthetic_addresses(args.rows, args.unique)
+    print(f"{args.rows} rows, {addresses.nunique()} distinct addresses")
+
+    failed = False
+    with tempfile.TemporaryDirectory() as tmp:
+        # Risk kuralı eksik adresleri hiç görmez (prepare onları eliyor)
+        for rule, old, text in (("risk", old_risk, addresses.dropna().astype(str)),
+                                ("figure", old_figure, addresses)):
+            path = Path(tmp) / f"{rule}.parquet"
+            reference, t_old = timed(lambda: old(text))
+            cold = street_normalizer.StreetNormalizer(rule, path)
+            (_, got_cold), t_cold = timed(lambda: cold.lookup(text))
+            warm = street_normalizer.StreetNormalizer(rule, path)
+            (_, got_warm), t_warm = timed(lambda: warm.lookup(text))
+            (_, got_hot), t_hot = timed(lambda: warm.lookup(text))
+
+            print(f"{rule:6} | per-row {t_old:.3f} s ({len(text) / t_old:,.0f} rows/s) | "
+                  f"cold {t_cold:.3f} s ({t_old / t_cold:.1f}x, {cold.extracted} extracted) | "
+                  f"warm from disk {t_warm:.3f} s ({t_old / t_warm:.1f}x, {warm.extracted} extracted) | "
+                  f"in memory {t_hot:.3f} s ({t_old / t_hot:.1f}x)")
+            for label, got in (("cold", got_cold), ("warm", got_warm), ("in memory", got_hot)):
+                mismatch = np.flatnonzero(np.array([not _same(a, b) for a, b in zip(got, reference)]))
+                if len(mismatch):
+                    failed = True
+                    i = mismatch[0]
+                    print(f"  MISMATCH {rule} {label}: {len(mismatch)} rows, e.g. "
+                          f"{text.iloc[i]!r}: {got[i]!r} != {reference[i]!r}")
+    if failed:
+        sys.exit(1)
+    print("identical to the per-row rules")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,147 @@
+// Per-keystroke latency of the explore page autocomplete: the old
+// lowercase + contains scan over every street (materialised, since the
+// options ListView asks for its length) vs. StreetSearchIndex, plus a
+// check that the index returns exactly the brute-force top-K.
+//
+//   dart run benchmark/street_search_benchmark.dart [--streets 30000]
+//
+// Street names are synthetic Lithuanian-looking words with diacritics;
+// each "user" types a random existing name (or a city) letter by letter,
+// sometimes without the diacritics.
+import 'dart:math';
+
+import 'package:safewayproject/street_search_index.dart';
+
+const List<String> _syllables = [
+  'ba', 'sa', 'vo', 'rių', 'ža', 'gi', 'lio', 'ša', 'kių', 'mai', 'ro',
+  'nė', 'ta', 'kos', 'ąž', 'uo', 'lų', 'ši', 'lo', 'ė', 'čiu', 'nio',
+  'dar', 'bų', 'vy', 'tau', 'to', 'pi', 'lie', 'tės', 'ker', 'šių',
+];
+const List<String> _kinds = ['g.', 'pr.', 'al.', 'skg.', 'pl.', 'tak.'];
+
+String _word(Random rnd) {
+  final buffer = StringBuffer();
+  for (int i = 0, n = 2 + rnd.nextInt(3); i < n; i++) {
+    buffer.write(_syllables[rnd.nextInt(_syllables.length)]);
+  }
+  final w = buffer.toString();
+  return w[0].toUpperCase() + w.substring(1);
+}
+
+String _stripDiacritics(String s) => s
+    .replaceAll('ą', 'a')
+    .replaceAll('ė', 'e')
+    .replaceAll('ž', 'z')
+    .replaceAll('š', 's')
+    .replaceAll('č', 'c')
+    .replaceAll('ų', 'u')
+    .replaceAll('Ž', 'Z')
+    .replaceAll('Š', 'S');
+
+List<int> _bruteForce(
+    List<String> foldedStreets, List<String> foldedCities, String raw, int k) {
+  final String q = foldDiacritics(raw.trim());
+  if (q.length < 3) return const [];
+  final List<List<int>> hits = [];
+  for (int i = 0; i < foldedStreets.length; i++) {
+    final int tier = matchTier(foldedStreets[i], foldedCities[i], q);
+    if (tier >= 0) hits.add([tier, i]);
+  }
+  hits.sort((a, b) => a[0] != b[0] ? a[0] - b[0] : a[1] - b[1]);
+  return [for (final h in hits.take(k)) h[1]];
+}
+
+class _Latency {
+  final List<int> micros = [];
+
+  void add(Stopwatch w) => micros.add(w.elapsedMicroseconds);
+
+  String summary() {
+    micros.sort();
+    int at(double q) => micros[min(micros.length - 1, (micros.length * q).floor())];
+    final mean = micros.reduce((a, b) => a + b) / micros.length;
+    return 'mean ${(mean / 1000).toStringAsFixed(3)} ms, '
+        'p50 ${at(0.5) / 1000} ms, p95 ${at(0.95) / 1000} ms, '
+        'max ${micros.last / 1000} ms';
+  }
+}
+
+void main(List<String> args) {
+  int count = 30000;
+  final i = args.indexOf('--streets');
+  if (i >= 0 && i + 1 < args.length) count = int.parse(args[i + 1]);
+
+  final rnd = Random(3);
+  final cityNames = [for (int c = 0; c < 60; c++) _word(rnd)];
+  final streets = <String>[];
+  final cities = <String>[];
+  for (int s = 0; s < count; s++) {
+    final String first = rnd.nextDouble() < 0.2 ? '${_word(rnd)} ' : '';
+    streets.add('$first${_word(rnd)} ${_kinds[rnd.nextInt(_kinds.length)]}');
+    cities.add(cityNames[min(59, (rnd.nextDouble() * rnd.nextDouble() * 60).floor())]);
+  }
+
+  final build = Stopwatch()..start();
+  final index = StreetSearchIndex.build(streets, cities);
+  build.stop();
+  print('$count streets, index built in ${build.elapsedMilliseconds} ms');
+
+  final foldedStreets = [for (final s in streets) foldDiacritics(s)];
+  final foldedCities = [for (final c in cities) foldDiacritics(c)];
+  final typed = <String>[];
+  for (int u = 0; u < 200; u++) {
+    String target = rnd.nextDouble() < 0.15
+        ? cityNames[rnd.nextInt(cityNames.length)]
+        : streets[rnd.nextInt(count)];
+    if (rnd.nextBool()) target = _stripDiacritics(target);
+    for (int n = 1; n <= target.length; n++) {
+      typed.add(target.substring(0, n));
+    }
+  }
+
+  final oldLatency = _Latency();
+  final newLatency = _Latency();
+  int oldShown = 0;
+  int newShown = 0;
+  int mismatches = 0;
+
+  for (final text in typed) {
+    final w = Stopwatch()..start();
+    final query = text.trim().toLowerCase();
+    final List<int> old = query.length < 3
+        ? const []
+        : [
+            for (int s = 0; s < count; s++)
+              if (streets[s].toLowerCase().contains(query) ||
+                  cities[s].toLowerCase().contains(query))
+                s,
+          ];
+    w.stop();
+    oldLatency.add(w);
+    oldShown += old.length;
+
+    w
+      ..reset()
+      ..start();
+    final List<int> hits = index.search(text);
+    w.stop();
+    newLatency.add(w);
+    newShown += hits.length;
+
+    final expected = _bruteForce(foldedStreets, foldedCities, text, index.maxResults);
+    if (expected.length != hits.length ||
+        Iterable.generate(hits.length).any((k) => hits[k] != expected[k])) {
+      mismatches++;
+    }
+  }
+
+  print('${typed.length} keystrokes');
+  print('contains scan : ${oldLatency.summary()}, '
+      '${(oldShown / typed.length).toStringAsFixed(0)} options on average');
+  print('search index  : ${newLatency.summary()}, '
+      '${(newShown / typed.length).toStringAsFixed(1)} options on average');
+  print(mismatches == 0
+      ? 'index top-${index.maxResults} identical to brute force'
+      : '$mismatches KEYSTROKES DIFFER FROM BRUTE FORCE');
+  if (mismatches != 0) throw StateError('index results differ');
+}
@@ -0,0 +1,79 @@
+// Synthetic cluster centres and drives shared by the benchmarks.
+//
+// Most centres sit around the three big cities, the rest are spread over
+// the whole of Lithuania, with 1-4 centres per street.
+import 'dart:math';
+
+class SyntheticStreet {
+  final String coordinateTuple;
+  final List<double> lats;
+  final List<double> lons;
+
+  SyntheticStreet(this.coordinateTuple, this.lats, this.lons);
+}
+
+const List<List<double>> cityCentres = [
+  [54.8985, 23.9036], // Kaunas
+  [54.6872, 25.2797], // Vilnius
+  [55.7033, 21.1443], // Klaipėda
+];
+
+double gaussian(Random rnd) =>
+    sqrt(-2 * log(1 - rnd.nextDouble())) * cos(2 * pi * rnd.nextDouble());
+
+List<double> randomPoint(Random rnd) {
+  if (rnd.nextDouble() < 0.7) {
+    final centre = cityCentres[rnd.nextInt(cityCentres.length)];
+    return [
+      centre[0] + gaussian(rnd) * 0.04,
+      centre[1] + gaussian(rnd) * 0.07,
+    ];
+  }
+  return [
+    53.9 + rnd.nextDouble() * 2.5,
+    21.0 + rnd.nextDouble() * 5.8,
+  ];
+}
+
+List<SyntheticStreet> generateStreets(int centres, Random rnd) {
+  final streets = <SyntheticStreet>[];
+  int made = 0;
+  while (made < centres) {
+    final int count = min(1 + rnd.nextInt(4), centres - made);
+    final base = randomPoint(rnd);
+    final lats = <double>[];
+    final lons = <double>[];
+    for (int i = 0; i < count; i++) {
+      lats.add(base[0] + (rnd.nextDouble() - 0.5) * 0.004);
+      lons.add(base[1] + (rnd.nextDouble() - 0.5) * 0.006);
+    }
+    final tuple = [
+      for (int i = 0; i < count; i++) '(${lats[i]}, ${lons[i]})',
+    ].join(', ');
+    streets.add(SyntheticStreet('[$tuple]', lats, lons));
+    made += count;
+  }
+  return streets;
+}
+
+/// A city drive sampled every [stepMeters] (what `distanceFilter` gives),
+/// with a gentle random heading change per step.
+List<List<double>> generateDrive(
+  Random rnd, {
+  required int fixes,
+  double stepMeters = 10,
+}) {
+  final centre = cityCentres[rnd.nextInt(cityCentres.length)];
+  double lat = centre[0];
+  double lon = centre[1];
+  double heading = rnd.nextDouble() * 2 * pi;
+  final drive = <List<double>>[];
+
+  for (int i = 0; i < fixes; i++) {
+    drive.add([lat, lon]);
+    heading += gaussian(rnd) * 0.15;
+    lat += stepMeters * cos(heading) / 111195;
+    lon += stepMeters * sin(heading) / (111195 * cos(lat * pi / 180));
+  }
+  return drive;
+}
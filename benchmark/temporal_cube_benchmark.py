@@ -0,0 +1,145 @@
+# Time-of-day and street-trend queries from raw rows (what Fig.1, Fig.11 and
+# Fig.2/15/16 did) against code/temporal_cube.py, a full cube build against
+# an incremental refresh after one year changes, and a check that every
+# query gives the same counts.
+#
+#   python benchmark/temporal_cube_benchmark.py [--rows 1000000]
+#
+# The accidents are synthetic store rows for 2020-2024: Laikas as a day
+# fraction (some missing), 60 municipalities and Zipf-distributed streets
+# in Nominatim-style addresses. Exits with status 1 on any mismatch.
+import argparse
+import os
+import shutil
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+#  Küp ve depo geçici klasörde; import'tan önce ayarlanmalı
+_STORE = tempfile.mkdtemp(prefix="cube_bench_")
+os.environ["SAFEWAY_STORE"] = _STORE
+
+import numpy as np
+import pandas as pd
+import pyarrow as pa
+import pyarrow.parquet as pq
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+import accident_store
+import temporal_cube
+from street_normalizer import streets
+
+YEARS = list(range(2020, 2025))
+CITIES = ["Vilniaus m. sav.", "Kauno m. sav.", "Klaipėdos m. sav.", "Šiaulių m. sav."]
+
+
+def synthetic_rows(rows, seed=0):
+    rnd = np.random.default_rng(seed)
+    muni_names = CITIES + [f"Rajonas{i} r. sav." for i in range(56)]
+    weights = 1.0 / np.arange(1, len(muni_names) + 1)
+    muni = rnd.choice(len(muni_names), rows, p=weights / weights.sum())
+    street = rnd.zipf(1.6, rows) % 3000
+    laikas = rnd.random(rows)
+    laikas[rnd.random(rows) < 0.02] = np.nan
+    city_word = np.array(["Vilniaus miesto savivaldybė", "Kauno miesto savivaldybė",
+                          "Klaipėdos miesto savivaldybė", "Šiaulių miesto savivaldybė"]
+                         + [f"Rajonas{i} rajono savivaldybė" for i in range(56)], dtype=object)
+    place = np.array(["Vilnius", "Kaunas", "Klaipėda", "Šiauliai"] + ["Seniūnija"] * 56, dtype=object)
+    address = [f"{n}, Gatvė{s} g., {place[m]}, {city_word[m]}, County, 00000, Lithuania"
+               for n, s, m in zip(rnd.integers(1, 50, rows), street, muni)]
+    return pd.DataFrame({
+        "Metai": rnd.choice(YEARS, rows),
+        "Laikas": laikas,
+        accident_store.COL_MUNICIPALITY_RAW: np.array(muni_names, dtype=object)[muni],
+        "address": address,
+    })
+
+
+def write_store(df, name):
+    target = accident_store.dataset_dir(name)
+    shutil.rmtree(target, ignore_errors=True)
+    pq.write_to_dataset(pa.Table.from_pandas(df, preserve_index=False), target,
+                        partition_cols=["Metai"], basename_template="part-{i}.parquet")
+    (target / "_SOURCE").write_text("synthetic\n", encoding="utf-8")
+    accident_store._open.cache_clear()
+    accident_store._load_cached.cache_clear()
+
+
+def timed(fn, repeat=1):
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        out = fn()
+        best = min(best, time.perf_counter() - start)
+    return out, best
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--rows", type=int, default=1_000_000)
+    args = parser.parse_args()
+
+    df = synthetic_rows(args.rows)
+    name = "bench"
+    write_store(df, name)
+    print(f"{args.rows} rows, {df['address'].nunique()} distinct addresses")
+
+    _, t_build = timed(lambda: temporal_cube.refresh(name))
+    cube = temporal_cube.cube(name)
+    print(f"cube build {t_build:.2f} s -> {len(cube)} cells ({args.rows / len(cube):.0f} rows per cell)")
+
+    #  Bir yıl değişti: yalnızca o yıl yeniden sayılır
+    changed = synthetic_rows(args.rows // len(YEARS), seed=1).assign(Metai=2024)
+    write_store(pd.concat([df[df["Metai"] != 2024], changed], ignore_index=True), name)
+    (years, _), t_refresh = timed(lambda: temporal_cube.refresh(name))
+    print(f"refresh after a new {years} partition {t_refresh:.2f} s ({t_build / t_refresh:.1f}x faster than a build)")
+
+    def rows(columns):
+        # Betiklerin yaptığı gibi: depodan oku, sonra say
+        accident_store._load_cached.cache_clear()
+        return accident_store.load(name, columns=columns)
+
+    def hours(years=None):
+        d = rows(["Metai", "Laikas"])
+        if years is not None:
+            d = d[d["Metai"].isin(years)]
+        return (d["Laikas"].dropna() * 24).astype(int).value_counts().sort_index()
+
+    def klaipeda_streets():
+        d = rows(["Metai", "address"])
+        d = d[d["address"].str.contains("Klaipėda|Klaipeda", case=False, na=False)]
+        return (pd.DataFrame({"Metai": d["Metai"].astype(int).to_numpy(),
+                              "Street": streets(d["address"], rule="figure")})
+                .groupby(["Metai", "Street"]).size())
+
+    def cube_counts(*args, **kwargs):
+        temporal_cube._cube.cache_clear()
+        return temporal_cube.counts(name, *args, **kwargs)
+
+    cases = {
+        "hour of day (Fig.1)": (hours, lambda: cube_counts("Hour")),
+        "hour in 2024 (Fig.11)": (lambda: hours([2024]), lambda: cube_counts("Hour", Metai=2024)),
+        "year x street, Klaipėda (Fig.2/15/16)": (
+            klaipeda_streets,
+            lambda: cube_counts(["Metai", "FigureStreet"], AddressCity="Klaipėda", Metai=YEARS),
+        ),
+    }
+    failed = False
+    for label, (from_rows, from_cube) in cases.items():
+        expected, t_rows = timed(from_rows, 3)
+        got, t_cube = timed(from_cube, 3)
+        same = (len(expected) == len(got)
+                and (expected.sort_index().to_numpy() == got.sort_index().to_numpy()).all()
+                and list(expected.sort_index().index) == list(got.sort_index().index))
+        failed |= not same
+        print(f"{label:40} | rows {t_rows * 1e3:8.1f} ms | cube {t_cube * 1e3:6.1f} ms "
+              f"({t_rows / t_cube:5.1f}x) | {'same' if same else 'MISMATCH'}")
+
+    shutil.rmtree(_STORE, ignore_errors=True)
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
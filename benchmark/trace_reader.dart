@@ -0,0 +1,110 @@
+// GPS traces for the replay benchmarks: GPX tracks (`<trkpt lat lon>` with
+// an optional `<time>`) or CSV files with `latitude,longitude[,time]`
+// columns (a header row is skipped; time is ISO 8601 or epoch seconds).
+import 'dart:io';
+
+import 'package:safewayproject/risk_spatial_index.dart';
+
+class TraceFix {
+  final double lat;
+  final double lon;
+
+  /// Seconds since the start of the trace.
+  final double seconds;
+
+  /// m/s from the neighbouring fixes, -1 when it cannot be derived.
+  final double speed;
+
+  const TraceFix(this.lat, this.lon, this.seconds, [this.speed = -1]);
+}
+
+/// Fixes of [path] as recorded; points without time are taken as 1 s
+/// apart.
+List<TraceFix> readTrace(String path) {
+  final String text = File(path).readAsStringSync();
+  final raw = path.toLowerCase().endsWith('.csv') ? _csv(text) : _gpx(text);
+  if (raw.isEmpty) return raw;
+
+  final double start = raw.first.seconds;
+  return [
+    for (int i = 0; i < raw.length; i++)
+      TraceFix(raw[i].lat, raw[i].lon, raw[i].seconds - start,
+          i == 0 ? -1 : _speed(raw[i - 1], raw[i])),
+  ];
+}
+
+/// [trace] linearly interpolated to one fix per second.
+List<TraceFix> resampleTo1Hz(List<TraceFix> trace) {
+  final List<TraceFix> samples = [];
+  if (trace.isEmpty) return samples;
+  int k = 0;
+  for (double t = trace.first.seconds; t <= trace.last.seconds; t += 1) {
+    while (k + 1 < trace.length && trace[k + 1].seconds < t) {
+      k++;
+    }
+    if (k + 1 >= trace.length) {
+      samples.add(TraceFix(trace.last.lat, trace.last.lon, t, 0));
+      break;
+    }
+    final TraceFix a = trace[k], b = trace[k + 1];
+    final double span = b.seconds - a.seconds;
+    final double f = span > 0 ? (t - a.seconds) / span : 0;
+    samples.add(TraceFix(
+      a.lat + f * (b.lat - a.lat),
+      a.lon + f * (b.lon - a.lon),
+      t,
+      _speed(a, b),
+    ));
+  }
+  return samples;
+}
+
+double _speed(TraceFix a, TraceFix b) {
+  final double span = b.seconds - a.seconds;
+  return span > 0 ? haversineMeters(a.lat, a.lon, b.lat, b.lon) / span : -1;
+}
+
+List<TraceFix> _gpx(String text) {
+  final RegExp point =
+      RegExp(r'<trkpt\b([^>]*?)(?:/>|>(.*?)</trkpt>)', dotAll: true);
+  final RegExp latAttribute = RegExp(r'\blat="([-0-9.eE+]+)"');
+  final RegExp lonAttribute = RegExp(r'\blon="([-0-9.eE+]+)"');
+  final RegExp time = RegExp(r'<time>([^<]+)</time>');
+
+  final List<TraceFix> fixes = [];
+  for (final m in point.allMatches(text)) {
+    final String attributes = m.group(1)!;
+    final String? latText = latAttribute.firstMatch(attributes)?.group(1);
+    final String? lonText = lonAttribute.firstMatch(attributes)?.group(1);
+    if (latText == null || lonText == null) continue;
+    fixes.add(TraceFix(
+      double.parse(latText),
+      double.parse(lonText),
+      _time(time.firstMatch(m.group(2) ?? '')?.group(1), fixes),
+    ));
+  }
+  return fixes;
+}
+
+List<TraceFix> _csv(String text) {
+  final List<TraceFix> fixes = [];
+  for (final line in text.split('\n')) {
+    final List<String> cells = line.trim().split(RegExp(r'[,;]\s*'));
+    if (cells.length < 2) continue;
+    final double? lat = double.tryParse(cells[0]);
+    final double? lon = double.tryParse(cells[1]);
+    if (lat == null || lon == null) continue; // başlık satırı
+    fixes.add(
+        TraceFix(lat, lon, _time(cells.length > 2 ? cells[2] : null, fixes)));
+  }
+  return fixes;
+}
+
+double _time(String? stamp, List<TraceFix> before) {
+  final double fallback = before.isEmpty ? 0 : before.last.seconds + 1;
+  if (stamp == null || stamp.isEmpty) return fallback;
+  final double? epoch = double.tryParse(stamp);
+  if (epoch != null) return epoch;
+  final DateTime? parsed = DateTime.tryParse(stamp);
+  return parsed == null ? fallback : parsed.millisecondsSinceEpoch / 1000;
+}
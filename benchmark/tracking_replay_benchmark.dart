@@ -0,0 +1,239 @@
+// Replays GPS tracks through the risk matcher with the fixed tracking
+// setting (high accuracy, 10 m filter) and with TrackingScheduler, and
+// reports fixes processed, searches run and alerts missed.
+//
+//   dart run benchmark/tracking_replay_benchmark.dart \
+//       [--map City_Level_Street_Risk.bin] [track.gpx|track.csv ...]
+//
+// Tracks are resampled to 1 Hz. The position stream is simulated from
+// that: a fix is delivered once the device has moved the profile's
+// distance filter, with noise matching the profile's accuracy. A street
+// "should alert" when any 1 Hz sample of the true track is within the
+// radius of it; it is missed when no delivered fix alerted it. Without
+// --map, synthetic streets are used; without tracks, synthetic one-hour
+// drives at 20 m/s out of the three big cities.
+import 'dart:io';
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:safewayproject/risk_alert_engine.dart';
+import 'package:safewayproject/risk_map.dart';
+import 'package:safewayproject/risk_segment_index.dart';
+import 'package:safewayproject/risk_spatial_index.dart';
+import 'package:safewayproject/tracking_scheduler.dart';
+
+import 'synthetic_risk_data.dart';
+import 'trace_reader.dart';
+
+const double _radius = 120.0;
+
+// geolocator'ın tipik yatay doğruluğu (metre)
+const Map<TrackingAccuracy, double> _accuracyMeters = {
+  TrackingAccuracy.high: 5,
+  TrackingAccuracy.medium: 30,
+  TrackingAccuracy.low: 100,
+};
+
+/// What the worker holds: points for streets without road geometry, the
+/// segment index for the rest.
+class _World {
+  final RiskSpatialIndex points;
+  final RiskSegmentIndex? segments;
+
+  _World(this.points, this.segments);
+
+  Set<int> within(double lat, double lon) => {
+        for (final hit in points.query(lat, lon, _radius)) hit.owner,
+        for (final hit in segments?.query(lat, lon, _radius) ?? const [])
+          hit.owner,
+      };
+
+  int get distanceChecks =>
+      points.distanceChecks + (segments?.distanceChecks ?? 0);
+}
+
+_World _loadWorld(String path) {
+  final RiskMap riskMap =
+      RiskMap.fromByteData(ByteData.sublistView(File(path).readAsBytesSync()));
+  final store = riskMap.coordinates;
+  final geometry = riskMap.segments;
+  final lats = <double>[], lons = <double>[], owners = <int>[];
+  final Int32List pointOwners = store.pointOwners();
+  for (int p = 0; p < store.pointCount; p++) {
+    if (!geometry.hasSegments(pointOwners[p])) {
+      lats.add(store.latitudes[p]);
+      lons.add(store.longitudes[p]);
+      owners.add(pointOwners[p]);
+    }
+  }
+  return _World(
+    RiskSpatialIndex.build(lats, lons, owners, cellSizeMeters: _radius),
+    geometry.isEmpty
+        ? null
+        : RiskSegmentIndex.build(geometry, cellSizeMeters: _radius),
+  );
+}
+
+_World _syntheticWorld(Random rnd) {
+  final streets = generateStreets(60000, rnd);
+  final lats = <double>[], lons = <double>[], owners = <int>[];
+  for (int s = 0; s < streets.length; s++) {
+    lats.addAll(streets[s].lats);
+    lons.addAll(streets[s].lons);
+    owners.addAll(List.filled(streets[s].lats.length, s));
+  }
+  return _World(
+    RiskSpatialIndex.build(lats, lons, owners, cellSizeMeters: _radius),
+    null,
+  );
+}
+
+List<TraceFix> _syntheticTrack(Random rnd) {
+  final drive = generateDrive(rnd, fixes: 3600, stepMeters: 20);
+  return [
+    for (int t = 0; t < drive.length; t++)
+      TraceFix(drive[t][0], drive[t][1], t.toDouble(), 20),
+  ];
+}
+
+class _Result {
+  int fixes = 0;
+  int searches = 0;
+  int gridRebuilds = 0;
+  int distanceChecks = 0;
+  int expected = 0;
+  int missed = 0;
+  double delaySeconds = 0;
+  int delayed = 0;
+  int switches = 0;
+  final Map<String, int> secondsPerProfile = {};
+}
+
+void _replay(
+  _World world,
+  List<TraceFix> track,
+  Set<int> Function(int second) truthAt,
+  bool adaptive,
+  Random rnd,
+  _Result result,
+) {
+  final scheduler = TrackingScheduler();
+  final engine =
+      RiskAlertEngine(world.points, world.segments, radiusMeters: _radius);
+  final int checksBefore = world.distanceChecks;
+  TrackingProfile profile = scheduler.profile;
+
+  final Map<int, int> firstTruth = {};
+  final Map<int, int> firstAlert = {};
+  TraceFix? last;
+
+  for (int t = 0; t < track.length; t++) {
+    final TraceFix sample = track[t];
+    for (final street in truthAt(t)) {
+      firstTruth.putIfAbsent(street, () => t);
+    }
+    result.secondsPerProfile.update(profile.name, (s) => s + 1,
+        ifAbsent: () => 1);
+
+    if (last != null &&
+        haversineMeters(last.lat, last.lon, sample.lat, sample.lon) <
+            profile.distanceFilter) {
+      continue;
+    }
+    last = sample;
+    result.fixes++;
+
+    // Profil doğruluğunda gürültülü konum
+    final double accuracy = _accuracyMeters[profile.accuracy]!;
+    final double lat =
+        sample.lat + gaussian(rnd) * accuracy / 2 / 111195;
+    final double lon = sample.lon +
+        gaussian(rnd) * accuracy / 2 / (111195 * cos(sample.lat * pi / 180));
+
+    final diff = engine.update(lat, lon, speed: sample.speed);
+    result.searches++;
+    for (final update in diff.added) {
+      firstAlert.putIfAbsent(update.street, () => t);
+    }
+
+    // Motor aday kümesini her yenilediğinde clearance da ölçülüyor
+    final RiskClearance? clearance = engine.clearance;
+    if (clearance != null) {
+      result.gridRebuilds++;
+      scheduler.updateClearance(
+          clearance.latitude, clearance.longitude, clearance.meters);
+    }
+    if (!adaptive) continue;
+    final TrackingProfile? next = scheduler.onFix(
+      lat,
+      lon,
+      speed: sample.speed,
+      accuracy: accuracy,
+      alertsActive: engine.active.isNotEmpty,
+    );
+    if (next != null) profile = next;
+  }
+
+  result.distanceChecks += world.distanceChecks - checksBefore;
+  result.switches += scheduler.switches;
+  result.expected += firstTruth.length;
+  firstTruth.forEach((street, t) {
+    final int? alerted = firstAlert[street];
+    if (alerted == null) {
+      result.missed++;
+    } else if (alerted > t) {
+      result.delayed++;
+      result.delaySeconds += alerted - t;
+    }
+  });
+}
+
+void main(List<String> args) {
+  final rnd = Random(18);
+  String? mapPath;
+  final List<String> gpx = [];
+  for (int i = 0; i < args.length; i++) {
+    if (args[i] == '--map' && i + 1 < args.length) {
+      mapPath = args[++i];
+    } else {
+      gpx.add(args[i]);
+    }
+  }
+
+  final _World world =
+      mapPath != null ? _loadWorld(mapPath) : _syntheticWorld(rnd);
+  // Doğruluk referansı ayrı index ile, sayaçlara karışmasın
+  final _World truthWorld =
+      mapPath != null ? _loadWorld(mapPath) : _syntheticWorld(Random(18));
+  final List<List<TraceFix>> tracks = gpx.isEmpty
+      ? [for (int i = 0; i < 10; i++) _syntheticTrack(rnd)]
+      : [for (final path in gpx) resampleTo1Hz(readTrace(path))];
+
+  final fixed = _Result(), adaptive = _Result();
+  int seconds = 0;
+  for (final track in tracks) {
+    seconds += track.length;
+    final List<Set<int>> truth = [
+      for (final s in track) truthWorld.within(s.lat, s.lon),
+    ];
+    _replay(world, track, (t) => truth[t], false, Random(1), fixed);
+    _replay(world, track, (t) => truth[t], true, Random(1), adaptive);
+  }
+
+  print('${tracks.length} tracks, ${(seconds / 3600).toStringAsFixed(1)} h '
+      'at 1 Hz, radius ${_radius.round()} m');
+  for (final entry in {'fixed 10 m': fixed, 'scheduler': adaptive}.entries) {
+    final r = entry.value;
+    final profiles = r.secondsPerProfile.entries
+        .map((e) => '${e.key} ${(100 * e.value / seconds).toStringAsFixed(0)}%')
+        .join(', ');
+    print('${entry.key.padRight(10)} | ${r.fixes} fixes processed | '
+        '${r.searches} searches (${r.gridRebuilds} grid rebuilds with a '
+        'clearance search) | '
+        '${r.distanceChecks} distance checks | '
+        '${r.missed}/${r.expected} alerts missed | '
+        '${r.delayed} late by '
+        '${(r.delaySeconds / max(r.delayed, 1)).toStringAsFixed(1)} s avg | '
+        '${r.switches} profile switches | $profiles');
+  }
+}
@@ -1,64 +1,44 @@
-import pandas as pd
-from pyproj import Transformer
-from tqdm import tqdm
-
-# Path to the original Excel file with accident coordinates
-file_path = r"C:\Users\mhone\Desktop\dosyaCordinat\2020-2024 accident.xlsx"
-
-# Read the Excel file (use the correct sheet name)
-df = pd.read_excel(file_path, sheet_name="2020-2024")
-
-# Remove any extra spaces from column names just in case
-df.columns = df.columns.str.strip()
-
-# Drop rows where either Ilguma or Platuma is missing
-df_clean = df.dropna(subset=['Ilguma', 'Platuma']).copy()
-
-# Convert coordinates to float:
-# - First, make sure they are strings
-# - Replace comma with dot as decimal separator
-# - Then convert to float type
-df_clean['Ilguma'] = (
-    df_clean['Ilguma']
-    .astype(str)
-    .str.replace(',', '.')
-    .astype(float)
-)
-
-df_clean['Platuma'] = (
-    df_clean['Platuma']
-    .astype(str)
-    .str.replace(',', '.')
-    .astype(float)
-)
+import argparse
+import sys
+from pathlib import Path
 
-# Define the coordinate transformer (from EPSG:3346 to EPSG:4326 / WGS84)
-transformer = Transformer.from_crs("EPSG:3346", "EPSG:4326", always_xy=True)
-
-# Lists to store transformed longitude and latitude values
-longitudes = []
-latitudes = []
-
-# Loop through all coordinate pairs and transform them
-# tqdm is used here to show a progress bar while processing
-for x, y in tqdm(
-    zip(df_clean['Platuma'], df_clean['Ilguma']),
-    total=len(df_clean),
-    desc="Converting coordinates"
-):
-    lon, lat = transformer.transform(x, y)
-    longitudes.append(lon)
-    latitudes.append(lat)
-
-# Add the new longitude/latitude columns to the cleaned DataFrame
-df_clean['Longitude'] = longitudes
-df_clean['Latitude'] = latitudes
-
-# Define the output path for the new Excel file
-output_path = r"C:\Users\mhone\Desktop\donusturulmus_kaza_koordinatlari.xlsx"
-
-# Save the transformed data to a new Excel file (without the index)
-df_clean.to_excel(output_path, index=False)
+from tqdm import tqdm
 
-# Simple confirmation message in the console
-print(f"Coordinates were successfully converted and saved to:\n{output_path}")
\ No newline at end of file
+# lks94.py lives next to this script
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from lks94 import DEFAULT_CHUNKSIZE, convert_file
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="Convert accident coordinates from LKS94 to WGS84.")
+    # Original Excel (or CSV) file with accident coordinates, or its
+    # accident_store dataset directory (e.g. accident_store/raw)
+    parser.add_argument("--input", default=r"C:\Users\mhone\Desktop\dosyaCordinat\2020-2024 accident.xlsx")
+    # Use the correct sheet name
+    parser.add_argument("--sheet", default="2020-2024")
+    # Output path for the new Excel (or CSV) file
+    parser.add_argument("--output", default=r"C:\Users\mhone\Desktop\donusturulmus_kaza_koordinatlari.xlsx")
+    # Rows transformed per NumPy batch; the input is streamed, never loaded whole
+    parser.add_argument("--chunksize", type=int, default=DEFAULT_CHUNKSIZE)
+    # >1 converts chunks in parallel processes
+    parser.add_argument("--workers", type=int, default=1)
+    return parser.parse_args()
+
+
+if __name__ == "__main__":
+    args = parse_args()
+
+    # Rows without Ilguma/Platuma are dropped, comma decimals are accepted and
+    # the new Longitude/Latitude columns are appended to every row
+    with tqdm(desc="Converting coordinates", unit="rows") as bar:
+        rows = convert_file(
+            args.input,
+            args.output,
+            sheet_name=args.sheet,
+            chunksize=args.chunksize,
+            workers=args.workers,
+            progress=lambda n: bar.update(n - bar.n),
+        )
+
+    # Simple confirmation message in the console
+    print(f"{rows} coordinates were successfully converted and saved to:\n{args.output}")
\ No newline at end of file
@@ -1,45 +1,144 @@
+import argparse
+import json
+import os
+import time
+from concurrent.futures import ThreadPoolExecutor, as_completed
+from pathlib import Path
+
 import pandas as pd
 from geopy.geocoders import Nominatim
 from geopy.extra.rate_limiter import RateLimiter
 from tqdm import tqdm
-import time
 
-#  Read the Excel file with already converted coordinates
-df = pd.read_excel("donusturulmus_kaza_koordinatlari.xlsx")
 
-#  Set up the Nominatim geocoder (note the timeout here)
-geolocator = Nominatim(user_agent="my_lithuania_reverse_geocoder_2025", timeout=10)
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Reverse geocode accident coordinates into full addresses."
+    )
+    parser.add_argument("--input", default="donusturulmus_kaza_koordinatlari.xlsx")
+    parser.add_argument("--output", default="kaza_adresli.xlsx")
+    # Local Nominatim-compatible server (e.g. one built from an OSM extract).
+    # Without it the public OpenStreetMap service is used, serially.
+    parser.add_argument("--endpoint", default=None,
+                        help="e.g. http://localhost:8080 for a local Nominatim")
+    parser.add_argument("--workers", type=int, default=8,
+                        help="concurrent requests (local endpoint only)")
+    parser.add_argument("--checkpoint", default=None,
+                        help="append-only JSONL store, default: <output>.checkpoint.jsonl")
+    parser.add_argument("--precision", type=int, default=5,
+                        help="decimals used to deduplicate coordinates (5 = ~1 m)")
+    return parser.parse_args()
+
+
+def make_geocoder(endpoint):
+    if endpoint is None:
+        #  Public Nominatim: respect the OpenStreetMap rate limit
+        geolocator = Nominatim(user_agent="my_lithuania_reverse_geocoder_2025", timeout=10)
+        return RateLimiter(
+            geolocator.reverse,
+            min_delay_seconds=1.1,
+            max_retries=3,
+            error_wait_seconds=5,
+            #  Errors reach reverse_one, which retries and leaves the
+            #  location out of the checkpoint instead of storing "no address"
+            swallow_exceptions=False
+        ), 1
 
-#  Wrap the reverse geocoder with a RateLimiter (no timeout here)
-geocode = RateLimiter(
-    geolocator.reverse,
-    min_delay_seconds=1.1,  # Respect OpenStreetMap rate limit
-    max_retries=3,
-    error_wait_seconds=5,
-    swallow_exceptions=True
-)
+    scheme, _, domain = endpoint.partition("://")
+    geolocator = Nominatim(
+        user_agent="safeway_local_reverse_geocoder",
+        domain=domain.rstrip("/"),
+        scheme=scheme or "http",
+        timeout=10,
+    )
+    return geolocator.reverse, None
 
-#  Create the address column if it does not exist yet
-if "address" not in df.columns:
-    df["address"] = None
 
-#  Prepare tqdm to show a nice progress bar in pandas-style
-tqdm.pandas(desc="Querying addresses")
+def coordinate_key(lat, lon, precision):
+    return f"{round(float(lat), precision):.{precision}f},{round(float(lon), precision):.{precision}f}"
 
-#  Iterate through all rows and fetch reverse geocoded addresses
-for idx, row in tqdm(df.iterrows(), total=len(df), desc="Reverse geocoding"):
-    if pd.isna(row["address"]):
+
+def load_checkpoint(path: Path) -> dict:
+    #  Every line is one finished location and is flushed as soon as it is
+    #  written, so a killed run loses at most the line in progress
+    done = {}
+    if not path.exists():
+        return done
+    with path.open("r", encoding="utf-8") as f:
+        for line in f:
+            try:
+                record = json.loads(line)
+            except json.JSONDecodeError:
+                continue  # half-written last line from a crash
+            done[record["key"]] = record["address"]
+    return done
+
+
+def reverse_one(geocode, key):
+    lat, lon = (float(v) for v in key.split(","))
+    for attempt in range(3):
         try:
-            # Call Nominatim with latitude/longitude and request English results
-            location = geocode((row["Latitude"], row["Longitude"]), language="en")
-            df.at[idx, "address"] = location.address if location else None
+            location = geocode((lat, lon), language="en")
+            return key, location.address if location else None, True
         except Exception as e:
-            # If something goes wrong, log the error and pause briefly
-            print(f"❌ Error (row {idx}): {e}")
-            time.sleep(10)  # Back off a bit if too many errors occur
+            print(f"❌ Error ({key}, attempt {attempt + 1}): {e}")
+            time.sleep(2 ** attempt)
+    #  Not checkpointed, so the next run tries this location again
+    return key, None, False
+
+
+def main():
+    args = parse_args()
+
+    #  Read the Excel file with already converted coordinates
+    df = pd.read_excel(args.input)
+
+    #  Create the address column if it does not exist yet
+    if "address" not in df.columns:
+        df["address"] = None
+
+    #  Same (rounded) coordinate is geocoded only once; rows that already
+    #  have an address or have no coordinates are left alone
+    todo = df["address"].isna() & df["Latitude"].notna() & df["Longitude"].notna()
+    df["_geo_key"] = None
+    df.loc[todo, "_geo_key"] = [
+        coordinate_key(lat, lon, args.precision)
+        for lat, lon in zip(df.loc[todo, "Latitude"], df.loc[todo, "Longitude"])
+    ]
+    unique_keys = df.loc[todo, "_geo_key"].drop_duplicates().tolist()
+
+    checkpoint_path = Path(args.checkpoint or f"{args.output}.checkpoint.jsonl")
+    done = load_checkpoint(checkpoint_path)
+    pending = [k for k in unique_keys if k not in done]
+    print(f"{len(df)} rows, {len(unique_keys)} distinct locations, "
+          f"{len(unique_keys) - len(pending)} already in {checkpoint_path}")
+
+    geocode, forced_workers = make_geocoder(args.endpoint)
+    workers = forced_workers or max(1, args.workers)
+
+    with checkpoint_path.open("a", encoding="utf-8") as store, \
+            ThreadPoolExecutor(max_workers=workers) as pool:
+        futures = [pool.submit(reverse_one, geocode, key) for key in pending]
+        for n, future in enumerate(
+            tqdm(as_completed(futures), total=len(futures), desc="Reverse geocoding"), 1
+        ):
+            key, address, ok = future.result()
+            if not ok:
+                continue
+            done[key] = address
+            store.write(json.dumps({"key": key, "address": address}, ensure_ascii=False) + "\n")
+            store.flush()
+            #  fsync only every 100 lines: a power loss may cost more than one
+            if n % 100 == 0:
+                os.fsync(store.fileno())
+
+    #  Save the updated DataFrame with addresses to a new Excel file
+    df.loc[todo, "address"] = df.loc[todo, "_geo_key"].map(done)
+    df = df.drop(columns="_geo_key")
+    df.to_excel(args.output, index=False)
+
+    print(f"✅ Done. Data with addresses has been saved to:\n{args.output}")
 
-#  Save the updated DataFrame with addresses to a new Excel file
-output_path = "kaza_adresli.xlsx"
-df.to_excel(output_path, index=False)
 
-print(f"✅ Done. Data with addresses has been saved to:\n{output_path}")
\ No newline at end of file
+if __name__ == "__main__":
+    main()
\ No newline at end of file
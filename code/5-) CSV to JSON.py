@@ -1,8 +1,31 @@
 import pandas as pd
+import ast
 import json
 from pathlib import Path
 
 
+def parse_coordinate_tuple(value) -> list:
+    # "[(54.90, 23.94), (54.88, 23.92)]" -> [[54.90, 23.94], [54.88, 23.92]]
+    if isinstance(value, str):
+        try:
+            value = ast.literal_eval(value)
+        except (ValueError, SyntaxError):
+            return []
+    if not isinstance(value, (list, tuple)):
+        return []
+    return [[float(lat), float(lon)] for lat, lon in value]
+
+
+def parse_slot_levels(value) -> list:
+    # "[1, 2, 3, ...]" -> [1, 2, 3, ...]; streets without accident times -> []
+    if isinstance(value, str) and value:
+        try:
+            return [int(v) for v in ast.literal_eval(value)]
+        except (ValueError, SyntaxError):
+            return []
+    return []
+
+
 def csv_to_json(csv_path: str, json_path: str, sep: str = ",") -> None:
 
     csv_file = Path(csv_path)
@@ -24,6 +47,13 @@ def csv_to_json(csv_path: str, json_path: str, sep: str = ",") -> None:
         if col in df.columns:
             df[col] = pd.to_numeric(df[col], errors="coerce")
 
+    # The app decodes coordinates straight into typed arrays, so they are
+    # written as real numeric arrays instead of stringified Python tuples.
+    if "Coordinate_Tuple" in df.columns:
+        df["Coordinate_Tuple"] = df["Coordinate_Tuple"].map(parse_coordinate_tuple)
+    if "Slot_risk_levels" in df.columns:
+        df["Slot_risk_levels"] = df["Slot_risk_levels"].map(parse_slot_levels)
+
 
     records = df.to_dict(orient="records")
 
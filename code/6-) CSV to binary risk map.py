@@ -0,0 +1,218 @@
+import argparse
+import ast
+import json
+import struct
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+# SafeWay risk map (.bin) layout, little-endian, read by the app's RiskMap.
+#
+#   header : magic b"SWRM", uint16 version, uint16 section count,
+#            uint32 street count, uint32 point count, uint32 string count,
+#            uint32 data version (v4+), then one uint32 byte offset per
+#            section
+#   section: 8-byte aligned, in SECTIONS order
+#
+# The data version is the risk table's version in risk_incremental.py
+# (1 for a full run, N after delta N). The app compares it with the map it
+# installed from deltas and uses whichever is newer.
+#
+# Strings (city and street names) are stored once in a UTF-8 string table;
+# the street columns only hold indices into it.
+MAGIC = b"SWRM"
+FORMAT_VERSION = 4
+
+SECTIONS = [
+    "string_offsets",   # uint32[string_count + 1]
+    "string_data",      # utf-8 bytes
+    "city",             # uint32[street_count], string index
+    "street",           # uint32[street_count], string index
+    "z_score",          # float32[street_count]
+    "total_accidents",  # uint32[street_count]
+    "cluster_count",    # uint32[street_count]
+    "risk_level",       # uint8[street_count], see RISK_LEVELS
+    "coord_offsets",    # int32[street_count + 1]
+    "latitudes",        # float32[point_count]
+    "longitudes",       # float32[point_count]
+    # v2: road stretches from snap_clusters_to_osm.py (empty if not run)
+    "segment_offsets",  # int32[street_count + 1], range of polylines
+    "polyline_offsets", # int32[polyline_count + 1], range of vertices
+    "segment_latitudes",   # float32[vertex_count]
+    "segment_longitudes",  # float32[vertex_count]
+    # v3: risk level per two-hour slot, 2 bits each (RISK_LEVELS codes,
+    # 0 = use risk_level), slot k of street i in byte i * 3 + k // 4 at
+    # bit 2 * (k % 4)
+    "slot_risk_level",  # uint8[street_count * SLOT_BYTES]
+]
+
+SLOTS = 12
+SLOT_BYTES = SLOTS // 4
+
+RISK_LEVELS = {"Low Risk": 1, "Medium Risk": 2, "High Risk": 3}
+
+
+def parse_coordinate_tuple(value) -> list:
+    if isinstance(value, str):
+        try:
+            value = ast.literal_eval(value)
+        except (ValueError, SyntaxError):
+            return []
+    if not isinstance(value, (list, tuple)):
+        return []
+    return [(float(lat), float(lon)) for lat, lon in value]
+
+
+def parse_slot_levels(value) -> list:
+    # "[1, 2, 3, ...]" -> 12 level codes; empty or malformed -> all 0
+    if isinstance(value, str):
+        try:
+            value = ast.literal_eval(value) if value else []
+        except (ValueError, SyntaxError):
+            return [0] * SLOTS
+    if not isinstance(value, (list, tuple)) or len(value) != SLOTS:
+        return [0] * SLOTS
+    return [int(v) for v in value]
+
+
+def pack_slot_levels(levels) -> np.ndarray:
+    codes = np.array(levels, dtype="u1").reshape(-1, SLOT_BYTES, 4)
+    return (codes[:, :, 0] | codes[:, :, 1] << 2 | codes[:, :, 2] << 4 | codes[:, :, 3] << 6).reshape(-1)
+
+
+def parse_segments(value) -> list:
+    if isinstance(value, str):
+        try:
+            value = json.loads(value) if value else []
+        except ValueError:
+            return []
+    if not isinstance(value, list):
+        return []
+    return [[(float(lat), float(lon)) for lat, lon in line] for line in value if len(line) >= 2]
+
+
+def _header_size(section_count: int) -> int:
+    return 4 + 2 + 2 + 4 * 4 + 4 * section_count
+
+
+def build_risk_map(df: pd.DataFrame, data_version: int = 1) -> bytes:
+    street_count = len(df)
+
+    strings = []
+    string_ids = {}
+
+    def intern(text) -> int:
+        text = "" if pd.isna(text) else str(text)
+        if text not in string_ids:
+            string_ids[text] = len(strings)
+            strings.append(text)
+        return string_ids[text]
+
+    city_ids = np.array([intern(c) for c in df["City"]], dtype="<u4")
+    street_ids = np.array([intern(s) for s in df["Street"]], dtype="<u4")
+
+    encoded = [s.encode("utf-8") for s in strings]
+    string_offsets = np.zeros(len(encoded) + 1, dtype="<u4")
+    string_offsets[1:] = np.cumsum([len(b) for b in encoded])
+
+    coords = [parse_coordinate_tuple(v) for v in df["Coordinate_Tuple"]]
+    coord_offsets = np.zeros(street_count + 1, dtype="<i4")
+    coord_offsets[1:] = np.cumsum([len(c) for c in coords])
+    flat = [p for street in coords for p in street]
+    latitudes = np.array([p[0] for p in flat], dtype="<f4")
+    longitudes = np.array([p[1] for p in flat], dtype="<f4")
+
+    if "Segments" in df.columns:
+        segments = [parse_segments(v) for v in df["Segments"]]
+    else:
+        segments = [[] for _ in range(street_count)]
+    segment_offsets = np.zeros(street_count + 1, dtype="<i4")
+    segment_offsets[1:] = np.cumsum([len(s) for s in segments])
+    lines = [line for street in segments for line in street]
+    polyline_offsets = np.zeros(len(lines) + 1, dtype="<i4")
+    polyline_offsets[1:] = np.cumsum([len(line) for line in lines])
+    vertices = [p for line in lines for p in line]
+
+    if "Slot_risk_levels" in df.columns:
+        slot_levels = [parse_slot_levels(v) for v in df["Slot_risk_levels"]]
+    else:
+        slot_levels = [[0] * SLOTS for _ in range(street_count)]
+
+    def numeric(col, dtype):
+        return pd.to_numeric(df[col], errors="coerce").fillna(0).to_numpy().astype(dtype)
+
+    payloads = {
+        "string_offsets": string_offsets.tobytes(),
+        "string_data": b"".join(encoded),
+        "city": city_ids.tobytes(),
+        "street": street_ids.tobytes(),
+        "z_score": numeric("Z_score", "<f4").tobytes(),
+        "total_accidents": numeric("Total_Accidents", "<u4").tobytes(),
+        "cluster_count": numeric("Total_Cluster_Number_DBSCAN", "<u4").tobytes(),
+        "risk_level": np.array(
+            [RISK_LEVELS.get(str(r), 0) for r in df["Risk_level"]], dtype="u1"
+        ).tobytes(),
+        "coord_offsets": coord_offsets.tobytes(),
+        "latitudes": latitudes.tobytes(),
+        "longitudes": longitudes.tobytes(),
+        "segment_offsets": segment_offsets.tobytes(),
+        "polyline_offsets": polyline_offsets.tobytes(),
+        "segment_latitudes": np.array([p[0] for p in vertices], dtype="<f4").tobytes(),
+        "segment_longitudes": np.array([p[1] for p in vertices], dtype="<f4").tobytes(),
+        "slot_risk_level": pack_slot_levels(slot_levels).tobytes(),
+    }
+
+    # her bölümü 8 byte hizalı yerleştiriyorum ki uygulama kopyalamadan view açabilsin
+    offsets = []
+    body = bytearray()
+    position = _header_size(len(SECTIONS))
+    for name in SECTIONS:
+        padding = (-position) % 8
+        body += b"\0" * padding
+        position += padding
+        offsets.append(position)
+        body += payloads[name]
+        position += len(payloads[name])
+
+    header = MAGIC + struct.pack(
+        f"<HHIIII{len(SECTIONS)}I",
+        FORMAT_VERSION,
+        len(SECTIONS),
+        street_count,
+        len(flat),
+        len(strings),
+        data_version,
+        *offsets,
+    )
+    return header + bytes(body)
+
+
+def csv_to_risk_map(csv_path: str, bin_path: str, sep: str = ",", data_version: int = 1) -> None:
+
+    csv_file = Path(csv_path)
+    bin_file = Path(bin_path)
+
+    if not csv_file.exists():
+        raise FileNotFoundError(f"Input CSV file not found: {csv_file}")
+
+    df = pd.read_csv(csv_file, sep=sep, encoding="utf-8-sig")
+
+    data = build_risk_map(df, data_version)
+    bin_file.write_bytes(data)
+
+    print(f"Binary risk map successfully created: {bin_file.resolve()} "
+          f"(data version {data_version}, {len(data)} bytes)")
+
+
+if __name__ == "__main__":
+
+    parser = argparse.ArgumentParser(description="Risk table CSV -> app risk map")
+    # risk_incremental.py ile üretilen tablo için risk_state/meta.json'daki "version"
+    parser.add_argument("--data-version", type=int, default=1)
+    args = parser.parse_args()
+
+    input_csv = "k_k_v_accidents_data_lithuanian.csv"
+    output_bin = "City_Level_Street_Risk.bin"
+
+    csv_to_risk_map(input_csv, output_bin, sep=",", data_version=args.data_version)
@@ -0,0 +1,296 @@
+"""Typed, partitioned Parquet copy of the accident workbooks.
+
+Parsing the xlsx files dominated every figure and pipeline script. Each
+workbook is now ingested once into a Parquet dataset partitioned by year
+(`Metai`) and municipality, and scripts read it back through `load()`,
+which only touches the requested columns and partitions:
+
+    python code/accident_store.py ingest            # both workbooks
+    python code/accident_store.py ingest --dataset raw
+
+    from accident_store import load
+    df = load("raw", columns=["Metai", "Laikas"], years=[2024])
+
+`load()` re-ingests automatically when the store is missing or older than
+its workbook, so scripts keep working from a fresh checkout.
+
+Storage types: Metai is Int64, coordinates are float64 (comma decimals
+accepted), Laikas is the fraction of the day as float64 whether the cell
+held an Excel time number or an "HH:MM:SS" string, and every other column
+is a string.
+"""
+import argparse
+import datetime as dt
+import os
+import shutil
+from functools import lru_cache
+from itertools import islice
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+import pyarrow as pa
+import pyarrow.dataset as ds
+import pyarrow.parquet as pq
+
+STORE_ROOT = Path(os.environ.get("SAFEWAY_STORE", "accident_store"))
+
+#  name -> (workbook, sheet); sheet None = first sheet
+DATASETS = {
+    "raw": ("2020-2024m_EI-duomenys_viesinama.xlsx", "2020-2024"),
+    "addressed": ("kaza_adresli.xlsx", None),
+}
+
+COL_YEAR = "Metai"
+COL_TIME = "Laikas"
+COL_MUNICIPALITY_RAW = "Administracinis teritorinis vienetas"
+#  Partition column derived from COL_MUNICIPALITY_RAW
+COL_MUNICIPALITY = "Savivaldybe"
+
+FLOAT_COLUMNS = ("Platuma", "Ilguma", "Latitude", "Longitude")
+
+CHUNK_ROWS = 100_000
+
+
+def laikas_to_day_fraction(values) -> np.ndarray:
+    """Decodes Laikas cells into the fraction of the day (0 <= t < 1).
+
+    The export mixes Excel time numbers with "HH:MM[:SS]" strings; openpyxl
+    also hands out datetime.time / datetime objects for formatted cells.
+    """
+    out = np.full(len(values), np.nan)
+    for i, v in enumerate(values):
+        if v is None or (isinstance(v, float) and np.isnan(v)):
+            continue
+        if isinstance(v, (int, float, np.number)):
+            out[i] = float(v) % 1.0
+        elif isinstance(v, dt.datetime):
+            out[i] = (v.hour * 3600 + v.minute * 60 + v.second) / 86400
+        elif isinstance(v, dt.time):
+            out[i] = (v.hour * 3600 + v.minute * 60 + v.second) / 86400
+        else:
+            text = str(v).strip()
+            try:
+                out[i] = float(text.replace(",", ".")) % 1.0
+                continue
+            except ValueError:
+                pass
+            parts = text.split(":")
+            try:
+                h, m = int(parts[0]), int(parts[1])
+                s = int(float(parts[2])) if len(parts) > 2 else 0
+            except (ValueError, IndexError):
+                continue
+            if 0 <= h < 24 and 0 <= m < 60 and 0 <= s < 60:
+                out[i] = (h * 3600 + m * 60 + s) / 86400
+    return out
+
+
+def _to_float(series: pd.Series) -> pd.Series:
+    if not pd.api.types.is_numeric_dtype(series):
+        series = series.astype(str).str.replace(",", ".", regex=False)
+    return pd.to_numeric(series, errors="coerce").astype("float64")
+
+
+def _typed_chunk(df: pd.DataFrame) -> pd.DataFrame:
+    #  Every chunk gets the same schema, whatever openpyxl inferred
+    df.columns = [str(c).strip() for c in df.columns]
+    df = df.loc[:, [c for c in df.columns if c and not c.startswith("Unnamed")]]
+    out = {}
+    for col in df.columns:
+        if col == COL_YEAR:
+            out[col] = pd.to_numeric(df[col], errors="coerce").astype("Int64")
+        elif col == COL_TIME:
+            out[col] = laikas_to_day_fraction(df[col].to_numpy(dtype=object))
+        elif col in FLOAT_COLUMNS:
+            out[col] = _to_float(df[col])
+        else:
+            s = df[col]
+            out[col] = s.where(s.isna(), s.astype(str)).astype("string")
+    typed = pd.DataFrame(out, index=df.index)
+    if COL_MUNICIPALITY_RAW in typed.columns:
+        typed[COL_MUNICIPALITY] = typed[COL_MUNICIPALITY_RAW].fillna("Unknown")
+    return typed
+
+
+def _iter_workbook(path, sheet_name, chunk_rows):
+    from openpyxl import load_workbook
+
+    workbook = load_workbook(path, read_only=True, data_only=True)
+    try:
+        sheet = workbook[sheet_name] if sheet_name else workbook.worksheets[0]
+        rows = sheet.iter_rows(values_only=True)
+        header = [str(c).strip() if c is not None else "" for c in next(rows)]
+        while True:
+            block = list(islice(rows, chunk_rows))
+            if not block:
+                break
+            yield pd.DataFrame(block, columns=header)
+    finally:
+        workbook.close()
+
+
+def dataset_dir(name: str) -> Path:
+    return STORE_ROOT / name
+
+
+def ingest(name: str, source=None, sheet_name=None, chunk_rows=CHUNK_ROWS) -> Path:
+    """Streams one workbook into `<STORE_ROOT>/<name>/`, replacing it."""
+    default_source, default_sheet = DATASETS.get(name, (None, None))
+    source = Path(source or default_source)
+    sheet_name = sheet_name or default_sheet
+    target = dataset_dir(name)
+    staging = target.with_name(target.name + ".tmp")
+    shutil.rmtree(staging, ignore_errors=True)
+
+    schema = None
+    rows = 0
+    for n, chunk in enumerate(_iter_workbook(source, sheet_name, chunk_rows)):
+        table = pa.Table.from_pandas(_typed_chunk(chunk), preserve_index=False)
+        if schema is None:
+            schema = table.schema
+        else:
+            table = table.select(schema.names).cast(schema)
+        partitioning = [c for c in (COL_YEAR, COL_MUNICIPALITY) if c in schema.names]
+        pq.write_to_dataset(
+            table,
+            staging,
+            partition_cols=partitioning,
+            basename_template=f"part-{n:05d}-{{i}}.parquet",
+        )
+        rows += table.num_rows
+
+    #  Readers never see a half-written store
+    shutil.rmtree(target, ignore_errors=True)
+    staging.rename(target)
+    (target / "_SOURCE").write_text(f"{source.resolve()}\n{rows}\n", encoding="utf-8")
+    _open.cache_clear()
+    _resident.pop(name, None)
+    _load_cached.cache_clear()
+    print(f"[OK] {source} -> {target} ({rows} rows)")
+
+    #  Zaman küpü burada tazelenir, yalnızca içeriği değişen yıllar
+    import temporal_cube
+    changed, dropped = temporal_cube.refresh(name)
+    print(f"[OK] cube {temporal_cube.cube_path(name)}: {len(changed)} year(s) re-aggregated, "
+          f"{len(dropped)} dropped")
+    return target
+
+
+def _is_stale(name: str) -> bool:
+    target = dataset_dir(name)
+    if not (target / "_SOURCE").exists():
+        return True
+    source = Path(DATASETS[name][0]) if name in DATASETS else None
+    return (source is not None and source.exists()
+            and source.stat().st_mtime > (target / "_SOURCE").stat().st_mtime)
+
+
+@lru_cache(maxsize=None)
+def _open(name: str) -> ds.Dataset:
+    if name in DATASETS and _is_stale(name):
+        ingest(name)
+    return ds.dataset(dataset_dir(name), format="parquet", partitioning="hive")
+
+
+def available_columns(name: str) -> list:
+    return list(_open(name).schema.names)
+
+
+def municipalities(name: str) -> list:
+    """Municipality partition values, without reading any data."""
+    dataset = _open(name)
+    if COL_MUNICIPALITY not in dataset.schema.names:
+        return []
+    found = set()
+    for fragment in dataset.get_fragments():
+        keys = ds.get_partition_keys(fragment.partition_expression)
+        if COL_MUNICIPALITY in keys:
+            found.add(keys[COL_MUNICIPALITY])
+    return sorted(found)
+
+
+#  name -> whole dataset as a pyarrow Table, see preload()
+_resident = {}
+
+
+def preload(name: str) -> None:
+    """Keeps all of dataset `name` in memory; later load() calls filter that
+    table instead of reading Parquet. The figure renderer does this before
+    forking its workers so they share one copy."""
+    _resident[name] = _open(name).to_table()
+    _load_cached.cache_clear()
+
+
+@lru_cache(maxsize=32)
+def _load_cached(name, columns, years, munis) -> pd.DataFrame:
+    dataset = ds.dataset(_resident[name]) if name in _resident else _open(name)
+    expr = None
+    if years is not None:
+        expr = ds.field(COL_YEAR).isin(list(years))
+    if munis is not None:
+        m = ds.field(COL_MUNICIPALITY).isin(list(munis))
+        expr = m if expr is None else expr & m
+    table = dataset.to_table(columns=list(columns) if columns else None, filter=expr)
+    df = table.to_pandas()
+    #  Partition columns come back as categoricals; Metai behaves like
+    #  read_excel did (int, or float when some years are missing)
+    if COL_YEAR in df.columns:
+        year = pd.to_numeric(df[COL_YEAR].astype("object"), errors="coerce")
+        df[COL_YEAR] = year.astype("int64") if year.notna().all() else year.astype("float64")
+    if COL_MUNICIPALITY in df.columns:
+        df[COL_MUNICIPALITY] = df[COL_MUNICIPALITY].astype("string")
+    return df
+
+
+def load(name: str, columns=None, years=None, municipality=None) -> pd.DataFrame:
+    """Reads `columns` of dataset `name`, pruning to `years` and to the
+    municipalities accepted by `municipality` (a list of partition values
+    or a predicate over them). Results are memoised per process; callers
+    get their own copy."""
+    munis = None
+    if municipality is not None:
+        if callable(municipality):
+            munis = [m for m in municipalities(name) if municipality(m)]
+        else:
+            munis = list(municipality)
+    key = (
+        name,
+        tuple(columns) if columns is not None else None,
+        tuple(sorted(int(y) for y in years)) if years is not None else None,
+        tuple(sorted(munis)) if munis is not None else None,
+    )
+    return _load_cached(*key).copy()
+
+
+def iter_batches(name: str, columns=None, batch_rows=CHUNK_ROWS):
+    """Streams dataset `name` (or a dataset directory) as DataFrames of at
+    most `batch_rows` rows."""
+    if name in DATASETS:
+        dataset = _open(name)
+    else:
+        dataset = ds.dataset(name, format="parquet", partitioning="hive")
+    for batch in dataset.to_batches(columns=columns, batch_size=batch_rows):
+        if batch.num_rows:
+            yield batch.to_pandas()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Accident workbook -> Parquet store")
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("ingest")
+    p.add_argument("--dataset", choices=sorted(DATASETS), action="append")
+    p.add_argument("--source", help="workbook path (only with a single --dataset)")
+    p.add_argument("--sheet")
+    args = parser.parse_args()
+
+    names = args.dataset or sorted(DATASETS)
+    for name in names:
+        if args.source is None and not Path(DATASETS[name][0]).exists():
+            print(f"[SKIP] {DATASETS[name][0]} not found")
+            continue
+        ingest(name, source=args.source, sheet_name=args.sheet)
+
+
+if __name__ == "__main__":
+    main()
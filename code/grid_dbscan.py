@@ -0,0 +1,182 @@
+"""DBSCAN on an eps-sized grid, label-for-label compatible with sklearn.
+
+sklearn's DBSCAN with metric='haversine' answers every radius query with a
+ball tree and a full haversine per visited node. Here points are bucketed
+into eps-sized cells of a local lat/lon (or metre) plane, sorted by cell,
+and each point is only compared with the later points of its own and the
+eight surrounding cells. Coordinates live in separate contiguous arrays
+(SoA) and the distance test runs on whole candidate blocks at once.
+
+    from grid_dbscan import GridDBSCAN
+    labels = GridDBSCAN(eps=200 / 6371000, min_samples=3,
+                        metric="haversine").fit_predict(np.radians(latlon))
+
+Labels match sklearn.cluster.DBSCAN: clusters are numbered in the order of
+their lowest-index core point and a border point reachable from several
+clusters joins the lowest-numbered one, exactly as sklearn's dbscan_inner
+expands them.
+"""
+import numpy as np
+from scipy.sparse import coo_matrix
+from scipy.sparse.csgraph import connected_components
+
+#  Candidate pairs evaluated per block; bounds peak memory
+_PAIRS_PER_BLOCK = 4_000_000
+
+_OFFSETS = [(dr, dc) for dr in (-1, 0, 1) for dc in (-1, 0, 1)]
+
+
+def _cells(X, eps, metric):
+    """Integer (row, col) cell of every point. Any two points within eps
+    end up in the same or adjacent cells."""
+    if metric == "haversine":
+        lat, lon = X[:, 0], X[:, 1]
+        #  sin(d/2) >= cos(lat1)cos(lat2) sin(dlon/2), so with the smallest
+        #  |cos(lat)| of the set this longitude step can never be too narrow
+        cos_min = max(np.cos(np.abs(lat)).min(), 1e-12)
+        lon_step = 2 * np.arcsin(min(1.0, np.sin(eps / 2) / cos_min))
+        return np.floor(lat / eps), np.floor(lon / lon_step)
+    if metric == "euclidean":
+        return np.floor(X[:, 0] / eps), np.floor(X[:, 1] / eps)
+    raise ValueError(f"unsupported metric: {metric}")
+
+
+def _within(metric, eps, a, b, cols):
+    """Vectorised distance test for candidate pairs (a[k], b[k])."""
+    if metric == "haversine":
+        lat, lon, cos_lat = cols
+        s_lat = np.sin((lat[b] - lat[a]) * 0.5)
+        s_lon = np.sin((lon[b] - lon[a]) * 0.5)
+        h = s_lat * s_lat + cos_lat[a] * cos_lat[b] * s_lon * s_lon
+        #  sklearn's trees compare this "reduced" distance, sin^2(d/2)
+        return h <= np.sin(eps / 2) ** 2
+    x, y = cols
+    dx = x[b] - x[a]
+    dy = y[b] - y[a]
+    return dx * dx + dy * dy <= eps * eps
+
+
+def neighbour_pairs(X, eps, metric="euclidean"):
+    """All pairs (i, j), i < j, with distance <= eps, as index arrays."""
+    X = np.asarray(X, dtype=np.float64)
+    n = len(X)
+    if n < 2:
+        return np.empty(0, np.int64), np.empty(0, np.int64)
+
+    row, col = _cells(X, eps, metric)
+    row = (row - row.min() + 1).astype(np.int64)
+    col = (col - col.min() + 1).astype(np.int64)
+    width = int(col.max()) + 2
+    key = row * width + col
+
+    order = np.argsort(key, kind="stable")
+    skey = key[order]
+    cell_keys, cell_start = np.unique(skey, return_index=True)
+    cell_end = np.append(cell_start[1:], n)
+
+    #  SoA, in cell order so every cell is one contiguous run
+    Xs = X[order]
+    if metric == "haversine":
+        cols = (np.ascontiguousarray(Xs[:, 0]), np.ascontiguousarray(Xs[:, 1]),
+                np.cos(Xs[:, 0]))
+    else:
+        cols = (np.ascontiguousarray(Xs[:, 0]), np.ascontiguousarray(Xs[:, 1]))
+
+    #  Candidate run [lo, hi) per point and neighbour cell, keeping only
+    #  later points so each pair is tested once
+    p = np.arange(n, dtype=np.int64)
+    lo = np.empty((len(_OFFSETS), n), np.int64)
+    hi = np.empty((len(_OFFSETS), n), np.int64)
+    for k, (dr, dc) in enumerate(_OFFSETS):
+        target = skey + dr * width + dc
+        pos = np.searchsorted(cell_keys, target)
+        pos_c = np.minimum(pos, len(cell_keys) - 1)
+        found = cell_keys[pos_c] == target
+        lo[k] = np.where(found, np.maximum(cell_start[pos_c], p + 1), 0)
+        hi[k] = np.where(found, cell_end[pos_c], 0)
+    counts = np.maximum(hi - lo, 0)
+    per_point = counts.sum(axis=0)
+
+    out_a, out_b = [], []
+    bounds = np.searchsorted(np.cumsum(per_point), np.arange(
+        _PAIRS_PER_BLOCK, per_point.sum() + _PAIRS_PER_BLOCK, _PAIRS_PER_BLOCK))
+    start = 0
+    for stop in np.unique(np.append(bounds + 1, n)):
+        stop = int(min(stop, n))
+        if stop <= start:
+            continue
+        c = counts[:, start:stop].ravel()
+        total = int(c.sum())
+        if total:
+            first = np.repeat(lo[:, start:stop].ravel(), c)
+            shift = np.repeat(np.cumsum(c) - c, c)
+            b = first + np.arange(total, dtype=np.int64) - shift
+            a = np.repeat(np.tile(p[start:stop], len(_OFFSETS)), c)
+            keep = _within(metric, eps, a, b, cols)
+            out_a.append(a[keep])
+            out_b.append(b[keep])
+        start = stop
+
+    if not out_a:
+        return np.empty(0, np.int64), np.empty(0, np.int64)
+    a = order[np.concatenate(out_a)]
+    b = order[np.concatenate(out_b)]
+    return np.minimum(a, b), np.maximum(a, b)
+
+
+def grid_dbscan(X, eps, min_samples=5, metric="euclidean"):
+    """Cluster labels (-1 = noise), as sklearn.cluster.DBSCAN would give."""
+    n = len(X)
+    labels = np.full(n, -1, dtype=np.int64)
+    if n == 0:
+        return labels
+    a, b = neighbour_pairs(X, eps, metric)
+
+    #  Like sklearn, a point is its own neighbour
+    n_neighbours = 1 + np.bincount(a, minlength=n) + np.bincount(b, minlength=n)
+    core = n_neighbours >= min_samples
+    core_idx = np.flatnonzero(core)
+    if len(core_idx) == 0:
+        return labels
+
+    both = core[a] & core[b]
+    graph = coo_matrix((np.ones(both.sum(), np.int8), (a[both], b[both])), shape=(n, n))
+    _, component = connected_components(graph, directed=False)
+
+    #  Clusters are numbered by their lowest-index core point
+    comp_of_core = component[core_idx]
+    first_comps, _ = np.unique(comp_of_core, return_index=True)
+    first_index = np.full(component.max() + 1, n, dtype=np.int64)
+    np.minimum.at(first_index, comp_of_core, core_idx)
+    ranked = np.argsort(first_index[first_comps], kind="stable")
+    cluster_of_comp = np.full(component.max() + 1, -1, dtype=np.int64)
+    cluster_of_comp[first_comps[ranked]] = np.arange(len(first_comps))
+    labels[core_idx] = cluster_of_comp[comp_of_core]
+
+    #  Border points join the lowest-numbered cluster that reaches them
+    border_a = ~core[a] & core[b]
+    border_b = core[a] & ~core[b]
+    border = np.concatenate((a[border_a], b[border_b]))
+    via = np.concatenate((labels[b[border_a]], labels[a[border_b]]))
+    if len(border):
+        best = np.full(n, np.iinfo(np.int64).max, dtype=np.int64)
+        np.minimum.at(best, border, via)
+        reached = best != np.iinfo(np.int64).max
+        labels[reached] = best[reached]
+    return labels
+
+
+class GridDBSCAN:
+    """Drop-in for the sklearn.cluster.DBSCAN calls in this repo."""
+
+    def __init__(self, eps=0.5, min_samples=5, metric="euclidean"):
+        self.eps = eps
+        self.min_samples = min_samples
+        self.metric = metric
+
+    def fit(self, X):
+        self.labels_ = grid_dbscan(X, self.eps, self.min_samples, self.metric)
+        return self
+
+    def fit_predict(self, X):
+        return self.fit(X).labels_
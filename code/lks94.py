@@ -0,0 +1,157 @@
+"""LKS94 (EPSG:3346) -> WGS84 (EPSG:4326) conversion used by script 1.
+
+Coordinates are transformed a whole NumPy chunk at a time instead of one
+pair per call. Inputs larger than memory are streamed in chunks (CSV via
+pandas, xlsx via openpyxl in read-only mode) and chunks can optionally be
+spread over several processes.
+"""
+from itertools import islice
+from multiprocessing import Pool
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+from pyproj import Transformer
+
+# In the police export 'Platuma' holds the easting and 'Ilguma' the northing
+X_COLUMN = "Platuma"
+Y_COLUMN = "Ilguma"
+
+DEFAULT_CHUNKSIZE = 200_000
+
+_transformer = None
+
+
+def get_transformer():
+    #  One transformer per process; pyproj objects are not shared across forks
+    global _transformer
+    if _transformer is None:
+        _transformer = Transformer.from_crs("EPSG:3346", "EPSG:4326", always_xy=True)
+    return _transformer
+
+
+def parse_decimal(values) -> np.ndarray:
+    """Accepts floats or strings with a comma decimal separator."""
+    series = pd.Series(values)
+    if pd.api.types.is_numeric_dtype(series):
+        return series.to_numpy(dtype=np.float64)
+    series = series.astype(str).str.replace(",", ".", regex=False)
+    try:
+        return series.astype(np.float64).to_numpy()
+    except ValueError:
+        #  Slow path only when some cell is not a number at all
+        return pd.to_numeric(series.str.strip(), errors="coerce").to_numpy(dtype=np.float64)
+
+
+def lks94_to_wgs84(x, y):
+    """Vectorised transform; returns (longitude, latitude) arrays."""
+    x = np.asarray(x, dtype=np.float64)
+    y = np.asarray(y, dtype=np.float64)
+    lon, lat = get_transformer().transform(x, y)
+    return np.asarray(lon), np.asarray(lat)
+
+
+def convert_frame(df: pd.DataFrame) -> pd.DataFrame:
+    """Same result as the old per-row loop: rows without coordinates are
+    dropped, Longitude / Latitude are appended."""
+    df = df.copy()
+    df.columns = df.columns.str.strip()
+    df = df.dropna(subset=[Y_COLUMN, X_COLUMN])
+
+    x = parse_decimal(df[X_COLUMN])
+    y = parse_decimal(df[Y_COLUMN])
+    df[X_COLUMN] = x
+    df[Y_COLUMN] = y
+
+    lon, lat = lks94_to_wgs84(x, y)
+    df["Longitude"] = lon
+    df["Latitude"] = lat
+    return df
+
+
+def _iter_excel(path, sheet_name, chunksize):
+    from openpyxl import load_workbook
+
+    workbook = load_workbook(path, read_only=True, data_only=True)
+    try:
+        sheet = workbook[sheet_name] if sheet_name else workbook.active
+        rows = sheet.iter_rows(values_only=True)
+        header = [str(c).strip() if c is not None else "" for c in next(rows)]
+        while True:
+            block = list(islice(rows, chunksize))
+            if not block:
+                break
+            yield pd.DataFrame(block, columns=header)
+    finally:
+        workbook.close()
+
+
+def iter_chunks(path, sheet_name=None, chunksize=DEFAULT_CHUNKSIZE):
+    """Yields DataFrames of at most `chunksize` rows without loading the file.
+
+    A directory is read as an accident_store dataset (see accident_store.py).
+    """
+    path = Path(path)
+    if path.is_dir():
+        import accident_store
+
+        yield from accident_store.iter_batches(str(path), batch_rows=chunksize)
+        return
+    if path.suffix.lower() == ".csv":
+        yield from pd.read_csv(path, chunksize=chunksize, dtype={X_COLUMN: str, Y_COLUMN: str})
+    else:
+        yield from _iter_excel(path, sheet_name, chunksize)
+
+
+class _ChunkWriter:
+    """Appends converted chunks to a CSV or a write-only xlsx workbook."""
+
+    def __init__(self, path, sheet_name="Sheet1"):
+        self.path = Path(path)
+        self.sheet_name = sheet_name
+        self.rows = 0
+        self._workbook = None
+        self._sheet = None
+
+    def write(self, df: pd.DataFrame):
+        if self.path.suffix.lower() == ".csv":
+            df.to_csv(self.path, mode="w" if self.rows == 0 else "a",
+                      header=self.rows == 0, index=False)
+        else:
+            if self._workbook is None:
+                from openpyxl import Workbook
+
+                self._workbook = Workbook(write_only=True)
+                self._sheet = self._workbook.create_sheet(self.sheet_name)
+                self._sheet.append(list(df.columns))
+            for row in df.itertuples(index=False, name=None):
+                self._sheet.append([None if pd.isna(v) else v for v in row])
+        self.rows += len(df)
+
+    def close(self):
+        if self._workbook is not None:
+            self._workbook.save(self.path)
+
+
+def convert_file(input_path, output_path, sheet_name=None,
+                 chunksize=DEFAULT_CHUNKSIZE, workers=1, progress=None):
+    """Streams `input_path` chunk by chunk into `output_path`.
+
+    With workers > 1 chunks are converted in a process pool; imap keeps the
+    original row order. Returns the number of rows written.
+    """
+    chunks = iter_chunks(input_path, sheet_name, chunksize)
+    writer = _ChunkWriter(output_path)
+    pool = Pool(workers) if workers > 1 else None
+    try:
+        converted = pool.imap(convert_frame, chunks) if pool else map(convert_frame, chunks)
+        for df in converted:
+            writer.write(df)
+            if progress is not None:
+                progress(writer.rows)
+    finally:
+        if pool is not None:
+            pool.close()
+            pool.join()
+        writer.close()
+    return writer.rows
@@ -0,0 +1,277 @@
+"""Renders every thesis figure headless, in parallel, skipping unchanged ones.
+
+Each figure script used to be started by hand: a fresh interpreter that
+imported pandas and matplotlib again, read its data again and stopped at
+`plt.show()` under TkAgg. Here the accident datasets are read once into
+memory (`accident_store.preload`), the workers are forked from that
+process, and every script runs through `runpy` with the Agg backend. A
+`plt.show()` saves the figures that were not saved already. The accident
+cubes (temporal_cube) the figures query are brought up to date before the
+fork, so workers only read them.
+
+    python code/render_figures.py                    # everything that changed
+    python code/render_figures.py fig01 fig11        # only these
+    python code/render_figures.py --force --jobs 4
+
+Run it from the folder with the workbooks and the risk CSV, as the
+scripts themselves expect. Each figure gets `<out>/<name>/` as its working
+directory. `<out>/manifest.json` records a SHA-256 per figure over:
+- the script
+- the code/ modules it imports, followed transitively
+- the Parquet files of the datasets it loads
+- the CSV files it reads
+- the basemap tiles of the areas it draws (`tile_cache.figure_areas`)
+
+A figure whose hash and output files are unchanged is not rendered again.
+Tiles downloaded on demand during a render count towards the hash recorded
+for it, so the next run does not render it a second time.
+"""
+import argparse
+import contextlib
+import hashlib
+import io
+import json
+import multiprocessing
+import os
+import re
+import runpy
+import sys
+import time
+import traceback
+from concurrent.futures import ProcessPoolExecutor, as_completed
+from pathlib import Path
+
+CODE_DIR = Path(__file__).resolve().parent
+FIGURE_DIR = CODE_DIR.parent / "list_of_illustrations"
+
+#  Workers chdir into their output folders, so the store and the tiles
+#  must not be relative to the working directory
+os.environ["SAFEWAY_STORE"] = str(Path(os.environ.get("SAFEWAY_STORE", "accident_store")).resolve())
+os.environ["SAFEWAY_TILES"] = str(Path(os.environ.get("SAFEWAY_TILES", "tile_cache")).resolve())
+os.environ["MPLBACKEND"] = "Agg"
+
+sys.path.insert(0, str(CODE_DIR))
+import accident_store
+import temporal_cube
+import tile_cache
+
+#  Bumped when the way figures are run changes, so everything re-renders
+RENDER_VERSION = 1
+
+#  name -> (script, datasets it loads, CSV files it reads, tile areas it draws)
+FIGURES = {
+    "fig01": ("Fig.1. Code.cpp", ("raw",), (), ()),
+    "fig02": ("Fig.2. Code.cpp", ("addressed",), (), ()),
+    "fig03-05": ("Fig.3. , Fig.4. and Fig. 5. Codes.cpp", ("raw",), (), ("Kaunas", "Vilnius", "Klaipėda")),
+    "fig06": ("Fig.6. Code.cpp", (), ("k_k_v_accidents_data_lithuanian.csv",), ("Vilnius-central",)),
+    "fig07-09": ("Fig.7. , Fig.8. and Fig. 9. Codes.cpp", ("addressed",), (), ()),
+    "fig10": ("Fig.10. Code.cpp", (), ("k_k_v_accidents_data_lithuanian.csv",), ()),
+    "fig11": ("Fig.11. Code.cpp", ("raw",), (), ()),
+    "fig15": ("Fig.15. Code.cpp", ("addressed",), (), ()),
+    "fig16": ("Fig.16. Code.cpp", ("addressed",), (), ()),
+}
+
+_IMPORT = re.compile(r"^\s*(?:from\s+(\w+)\s+import|import\s+(\w+))", re.MULTILINE)
+
+
+def _local_imports(path: Path, seen=None) -> set:
+    """code/ modules imported by `path`, directly or through each other."""
+    seen = set() if seen is None else seen
+    for m in _IMPORT.finditer(path.read_text(encoding="utf-8")):
+        module = CODE_DIR / f"{m.group(1) or m.group(2)}.py"
+        if module.exists() and module not in seen:
+            seen.add(module)
+            _local_imports(module, seen)
+    return seen
+
+
+def _digest_files(h, paths, root=None):
+    for path in sorted(paths):
+        label = path.relative_to(root).as_posix() if root is not None else path.name
+        h.update(label.encode("utf-8") + b"\0")
+        with open(path, "rb") as f:
+            for block in iter(lambda: f.read(1 << 20), b""):
+                h.update(block)
+
+
+def _tiles(area: str) -> list:
+    """Tiles of `area` that are in the store."""
+    provider, zoom, bounds = tile_cache.figure_areas()[area]
+    x0, x1, y0, y1 = tile_cache.tile_range(*bounds, zoom)
+    paths = (tile_cache.tile_path(provider, zoom, x, y)
+             for x in range(x0, x1 + 1) for y in range(y0, y1 + 1))
+    return [path for path in paths if path.exists()]
+
+
+def figure_hash(name: str, data_dir: Path) -> str:
+    script, datasets, csvs, areas = FIGURES[name]
+    h = hashlib.sha256(f"{RENDER_VERSION}|{name}".encode("utf-8"))
+    path = FIGURE_DIR / script
+    _digest_files(h, [path, *_local_imports(path)])
+    for dataset in datasets:
+        # Depo eskiyse önce yeniden oluşturuluyor, hash yeni içerikten
+        accident_store._open(dataset)
+        root = accident_store.dataset_dir(dataset)
+        h.update(f"dataset {dataset}".encode("utf-8"))
+        _digest_files(h, list(root.rglob("*.parquet")), root)
+    for csv in csvs:
+        h.update(f"csv {csv}".encode("utf-8"))
+        _digest_files(h, [data_dir / csv])
+    for area in areas:
+        # Eksik karo hash'e girmiyor; indirildiğinde hash değişiyor
+        h.update(f"tiles {area} {tile_cache.figure_areas()[area]}".encode("utf-8"))
+        _digest_files(h, _tiles(area), tile_cache.TILE_ROOT)
+    return h.hexdigest()
+
+
+def _headless():
+    """Agg everywhere; show() saves what the script did not save itself."""
+    import matplotlib
+    matplotlib.use("Agg")
+    matplotlib.use = lambda *args, **kwargs: None
+    import matplotlib.pyplot as plt
+    from matplotlib.figure import Figure
+
+    savefig = Figure.savefig
+
+    def tracked_savefig(self, *args, **kwargs):
+        self._safeway_saved = True
+        return savefig(self, *args, **kwargs)
+
+    Figure.savefig = tracked_savefig
+    plt.show = lambda *args, **kwargs: None
+
+
+def _flush_figures(name):
+    """Saves every open figure the script did not save, then closes all."""
+    import matplotlib.pyplot as plt
+    unsaved = [plt.figure(n) for n in plt.get_fignums()
+               if not getattr(plt.figure(n), "_safeway_saved", False)]
+    for i, fig in enumerate(unsaved):
+        fig.savefig(f"{name}.png" if len(unsaved) == 1 else f"{name}_{i + 1}.png", dpi=300)
+    plt.close("all")
+
+
+def _render(name: str, out_dir: str, data_dir: str):
+    """Runs one figure script in `<out_dir>/<name>/`; returns
+    (name, seconds, output files, captured output, error or None)."""
+    import matplotlib.pyplot as plt
+
+    script, _, csvs, _ = FIGURES[name]
+    job_dir = Path(out_dir) / name
+    job_dir.mkdir(parents=True, exist_ok=True)
+    links = []
+    log = io.StringIO()
+    error = None
+    start = time.perf_counter()
+    cwd = os.getcwd()
+    try:
+        # Betikler CSV'yi çalışma klasöründen okuyor
+        for csv in csvs:
+            link = job_dir / csv
+            if not link.exists():
+                link.symlink_to(Path(data_dir) / csv)
+                links.append(link)
+        os.chdir(job_dir)
+        with contextlib.redirect_stdout(log), contextlib.redirect_stderr(log):
+            plt.show = lambda *args, **kwargs: _flush_figures(name)
+            runpy.run_path(str(FIGURE_DIR / script), run_name="__main__")
+            _flush_figures(name)
+    except BaseException:
+        error = traceback.format_exc()
+    finally:
+        os.chdir(cwd)
+        for link in links:
+            link.unlink()
+        plt.close("all")
+    outputs = sorted(str(p.relative_to(job_dir)) for p in job_dir.rglob("*") if p.is_file())
+    return name, time.perf_counter() - start, outputs, log.getvalue(), error
+
+
+def _init_worker(datasets):
+    _headless()
+    # fork'ta zaten bellekte; spawn'da her işçi bir kez okur
+    for dataset in datasets:
+        if dataset not in accident_store._resident:
+            accident_store.preload(dataset)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Headless, parallel, incremental figure rendering")
+    parser.add_argument("figures", nargs="*", help=f"subset of {', '.join(FIGURES)}")
+    parser.add_argument("--out", default="figures")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count())
+    parser.add_argument("--force", action="store_true", help="render even when nothing changed")
+    parser.add_argument("--verbose", action="store_true", help="print what the scripts print")
+    args = parser.parse_args()
+
+    unknown = [f for f in args.figures if f not in FIGURES]
+    if unknown:
+        parser.error(f"unknown figure(s) {', '.join(unknown)}; known: {', '.join(FIGURES)}")
+    out_dir = Path(args.out).resolve()
+    data_dir = Path.cwd()
+    manifest_path = out_dir / "manifest.json"
+    manifest = json.loads(manifest_path.read_text(encoding="utf-8")) if manifest_path.exists() else {}
+
+    started = time.perf_counter()
+    todo, hashes, failed = [], {}, []
+    for name in args.figures or FIGURES:
+        try:
+            hashes[name] = figure_hash(name, data_dir)
+        except Exception as e:
+            print(f"[FAIL] {name}: inputs unavailable ({e})")
+            failed.append(name)
+            continue
+        entry = manifest.get(name, {})
+        current = (entry.get("hash") == hashes[name] and entry.get("outputs")
+                   and all((out_dir / name / o).exists() for o in entry["outputs"]))
+        if current and not args.force:
+            print(f"[SKIP] {name}: unchanged")
+        else:
+            todo.append(name)
+
+    if todo:
+        datasets = sorted({d for name in todo for d in FIGURES[name][1]})
+        _headless()
+        for dataset in datasets:
+            accident_store.preload(dataset)
+        # Eksik ya da eski sürüm küpler işçiler çatallanmadan önce bir kez kurulur
+        cube_path = CODE_DIR / "temporal_cube.py"
+        for dataset in sorted({d for name in todo
+                               if cube_path in _local_imports(FIGURE_DIR / FIGURES[name][0])
+                               for d in FIGURES[name][1]}):
+            temporal_cube.cube(dataset)
+        context = (multiprocessing.get_context("fork")
+                   if "fork" in multiprocessing.get_all_start_methods() else None)
+        with ProcessPoolExecutor(max_workers=max(1, min(args.jobs, len(todo))), mp_context=context,
+                                 initializer=_init_worker, initargs=(datasets,)) as pool:
+            futures = [pool.submit(_render, name, str(out_dir), str(data_dir)) for name in todo]
+            for future in as_completed(futures):
+                name, seconds, outputs, log, error = future.result()
+                if args.verbose or error:
+                    sys.stdout.write(log)
+                if error:
+                    print(f"[FAIL] {name} after {seconds:.1f} s\n{error}")
+                    failed.append(name)
+                    manifest.pop(name, None)
+                    continue
+                print(f"[OK] {name}: {seconds:.1f} s, {len(outputs)} file(s)")
+                if FIGURES[name][3]:
+                    # Çizim sırasında indirilen karolar da kayda geçsin
+                    hashes[name] = figure_hash(name, data_dir)
+                manifest[name] = {"hash": hashes[name], "outputs": outputs}
+
+        out_dir.mkdir(parents=True, exist_ok=True)
+        tmp = manifest_path.with_name(manifest_path.name + ".tmp")
+        tmp.write_text(json.dumps(manifest, indent=1, sort_keys=True), encoding="utf-8")
+        tmp.replace(manifest_path)
+
+    print(f"{len(todo) - len([f for f in failed if f in todo])} rendered, "
+          f"{len(hashes) - len(todo)} unchanged, {len(failed)} failed "
+          f"in {time.perf_counter() - started:.1f} s -> {out_dir}")
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,300 @@
+"""Street risk levels and DBSCAN hot spots for every municipality at once.
+
+Replaces the per-city loops of scripts 3 and 4. City and street are
+derived once per row, rows are grouped by (city, street) in one sort, and
+z-scores and clustering work on the resulting index ranges instead of
+re-filtering the DataFrame for every street.
+
+    python code/risk_engine.py --output k_k_v_accidents_data_lithuanian.csv
+    python code/risk_engine.py --cities Kaunas Vilnius
+
+The output has the columns scripts 5 and 6 read (City, Street, Risk_level,
+Z_score, Total_Cluster_Number_DBSCAN, Total_Accidents, Coordinate_Tuple,
+Slot_risk_levels).
+
+Slot_risk_levels is the risk level of the street in each two-hour slot of
+the day (00-02, 02-04, ... 22-24), as "[1, 2, 3, ...]" with the codes of
+script 6 (1 low, 2 medium, 3 high). It is empty for streets without any
+accident time; the app then uses Risk_level around the clock.
+"""
+import argparse
+import os
+import sys
+from concurrent.futures import ProcessPoolExecutor
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from accident_store import COL_TIME, available_columns, laikas_to_day_fraction, load
+from grid_dbscan import GridDBSCAN
+import street_normalizer
+from street_normalizer import (CITY_MUNICIPALITIES, STREET_PATTERN, UNKNOWN_STREET, backup_street,
+                               municipality_from_address, normalize_municipality)
+
+#  First and last year of a full run; prepare() takes None for "no bound"
+YEARS = (2020, 2024)
+EPS_METERS = 200
+EARTH_RADIUS = 6371000
+MIN_SAMPLES = 3
+
+#  Parallel clustering: streets are packed into batches of about this many
+#  points so that thousands of 3-point streets do not cost one task each
+BATCH_POINTS = 4000
+
+COL_MUNICIPALITY_RAW = "Administracinis teritorinis vienetas"
+
+#  Two-hour slots of the day, as in Fig.11
+SLOTS = 12
+NO_SLOT = -1
+SLOT_LEVEL_CODES = {'Low Risk': 1, 'Medium Risk': 2, 'High Risk': 3}
+
+HIGH_Z = 1.0
+MEDIUM_Z = -0.5
+
+
+def risk_level(z):
+    if z > HIGH_Z:
+        return 'High Risk'
+    elif z >= MEDIUM_Z:
+        return 'Medium Risk'
+    else:
+        return 'Low Risk'
+
+
+def time_slots(laikas: pd.Series) -> np.ndarray:
+    """Two-hour slot (0-11) of each Laikas value, NO_SLOT when missing.
+    Store rows hold a day fraction; workbook batches may still hold Excel
+    times or "HH:MM" strings."""
+    if pd.api.types.is_float_dtype(laikas):
+        t = laikas.to_numpy(dtype=np.float64, na_value=np.nan)
+    else:
+        t = laikas_to_day_fraction(laikas.to_numpy(dtype=object))
+    slot = np.clip(np.floor(t * SLOTS), 0, SLOTS - 1)
+    return np.where(np.isnan(t), NO_SLOT, slot).astype(np.int8)
+
+
+def extract_streets(addresses: pd.Series) -> np.ndarray:
+    return street_normalizer.streets(addresses)
+
+
+def prepare(df: pd.DataFrame, cities=None, years=YEARS) -> pd.DataFrame:
+    """One row per usable accident with City and Street, sorted so every
+    (City, Street) group is a contiguous block. `years` is the inclusive
+    (first, last) window of Metai; either end may be None."""
+    first, last = years
+    in_window = pd.Series(True, index=df.index)
+    if first is not None:
+        in_window &= df['Metai'] >= first
+    if last is not None:
+        in_window &= df['Metai'] <= last
+    df = df[
+        in_window &
+        df['Latitude'].notna() &
+        df['Longitude'].notna() &
+        df['address'].notna()
+    ]
+    #  Şehir ve sokak aynı önbellekten, benzersiz adres başına bir kez
+    address_city, street = street_normalizer.normalizer("risk").lookup(df['address'].astype(str))
+    if COL_MUNICIPALITY_RAW in df.columns:
+        city = df[COL_MUNICIPALITY_RAW].map(normalize_municipality).to_numpy(dtype=object)
+        missing = pd.isna(city)
+        city[missing] = address_city[missing]
+    else:
+        city = address_city
+
+    out = pd.DataFrame({
+        'City': city,
+        'Street': street,
+        'Latitude': df['Latitude'].to_numpy(dtype=np.float64),
+        'Longitude': df['Longitude'].to_numpy(dtype=np.float64),
+        'Slot': time_slots(df[COL_TIME]) if COL_TIME in df.columns else NO_SLOT,
+    })
+    out = out[out['City'].notna()]
+    if cities is not None:
+        out = out[out['City'].isin(list(cities))]
+    return out.sort_values(['City', 'Street'], kind='stable').reset_index(drop=True)
+
+
+def group_ranges(rows: pd.DataFrame):
+    """(city, street, start, end) for each contiguous block of `rows`."""
+    city = rows['City'].to_numpy()
+    street = rows['Street'].to_numpy()
+    if len(rows) == 0:
+        return []
+    change = (city[1:] != city[:-1]) | (street[1:] != street[:-1])
+    starts = np.concatenate(([0], np.flatnonzero(change) + 1))
+    ends = np.concatenate((starts[1:], [len(rows)]))
+    return [(city[s], street[s], int(s), int(e)) for s, e in zip(starts, ends)]
+
+
+def slot_counts(slots: np.ndarray, groups) -> np.ndarray:
+    """Accidents of each group (street) per two-hour slot, shape (groups, SLOTS)."""
+    owner = np.repeat(np.arange(len(groups)), [e - s for _, _, s, e in groups])
+    timed = slots != NO_SLOT
+    flat = np.bincount(owner[timed] * SLOTS + slots[timed].astype(np.int64),
+                       minlength=len(groups) * SLOTS)
+    return flat.reshape(len(groups), SLOTS)
+
+
+def slot_levels(cities, counts: np.ndarray) -> list:
+    """Slot_risk_levels per street: its count in each slot z-scored within
+    its city and classed like risk_level. "" for streets without a timed
+    accident."""
+    counts = pd.DataFrame(counts, dtype=np.float64)
+    by_city = counts.groupby(np.asarray(cities, dtype=object))
+    z = (counts - by_city.transform('mean')) / by_city.transform('std')
+    #  risk_level() over a matrix; NaN (one-street city) is low, as there
+    z = z.to_numpy()
+    codes = np.select([z > HIGH_Z, z >= MEDIUM_Z],
+                      [SLOT_LEVEL_CODES['High Risk'], SLOT_LEVEL_CODES['Medium Risk']],
+                      SLOT_LEVEL_CODES['Low Risk'])
+    timed = counts.sum(axis=1).to_numpy() > 0
+    return [str([int(c) for c in row]) if t else '' for row, t in zip(codes, timed)]
+
+
+def score_streets(groups, slots=None) -> pd.DataFrame:
+    """Z-score of each street's accident count within its city, overall
+    and per two-hour slot (`slots`: the Slot column of the rows)."""
+    streets = pd.DataFrame(groups, columns=['City', 'Street', 'start', 'end'])
+    streets['Total_Accidents'] = streets['end'] - streets['start']
+    by_city = streets.groupby('City')['Total_Accidents']
+    streets['Z_score'] = (
+        (streets['Total_Accidents'] - by_city.transform('mean')) / by_city.transform('std')
+    )
+    streets['Risk_level'] = streets['Z_score'].map(risk_level)
+    if slots is None:
+        streets['Slot_risk_levels'] = ''
+    else:
+        streets['Slot_risk_levels'] = slot_levels(streets['City'], slot_counts(slots, groups))
+    return streets
+
+
+def cluster_centres(coords: np.ndarray):
+    """DBSCAN (haversine, 200 m, 3 points) cluster centres of one street."""
+    if len(coords) < MIN_SAMPLES:
+        return []
+    #  Same labels as sklearn's DBSCAN(metric='haversine'), see grid_dbscan.py
+    db = GridDBSCAN(eps=EPS_METERS / EARTH_RADIUS, min_samples=MIN_SAMPLES, metric='haversine')
+    labels = db.fit_predict(np.radians(coords))
+    return [
+        (coords[labels == label, 0].mean(), coords[labels == label, 1].mean())
+        for label in np.unique(labels)
+        if label != -1
+    ]
+
+
+def _cluster_batch(batch):
+    coords, bounds = batch
+    return [cluster_centres(coords[s:e]) for s, e in bounds]
+
+
+def _make_batches(coords, ranges, batch_points):
+    """Packs consecutive streets into batches that carry only their own
+    points, with offsets relative to the batch."""
+    batches = []
+    i = 0
+    while i < len(ranges):
+        j, points = i, 0
+        while j < len(ranges) and (j == i or points < batch_points):
+            points += ranges[j][1] - ranges[j][0]
+            j += 1
+        bounds, offset = [], 0
+        for s, e in ranges[i:j]:
+            bounds.append((offset, offset + e - s))
+            offset += e - s
+        batches.append((np.concatenate([coords[s:e] for s, e in ranges[i:j]]), bounds))
+        i = j
+    return batches
+
+
+def cluster_streets(coords, ranges, workers=1, batch_points=BATCH_POINTS):
+    """Cluster centres for every (start, end) slice of `coords`, keyed by
+    the slice.
+
+    With workers > 1 the batches run in a process pool. Executor.map keeps
+    submission order, so the result is the same as the serial loop.
+    """
+    ranges = [(s, e) for s, e in ranges if e - s >= MIN_SAMPLES]
+    if workers <= 1 or len(ranges) < 2:
+        centres = [cluster_centres(coords[s:e]) for s, e in ranges]
+    else:
+        batches = _make_batches(coords, ranges, batch_points)
+        with ProcessPoolExecutor(max_workers=workers) as pool:
+            centres = [c for part in pool.map(_cluster_batch, batches) for c in part]
+    return dict(zip(ranges, centres))
+
+
+TABLE_COLUMNS = [
+    'City', 'Street', 'Risk_level', 'Z_score',
+    'Total_Cluster_Number_DBSCAN', 'Total_Accidents', 'Coordinate_Tuple',
+    'Slot_risk_levels',
+]
+
+
+def risky_streets(streets: pd.DataFrame) -> pd.DataFrame:
+    #  High & Medium Risk sokaklar, bilinmeyen sokaklar hariç
+    return streets[
+        streets['Risk_level'].isin(['High Risk', 'Medium Risk']) &
+        (streets['Street'] != UNKNOWN_STREET)
+    ]
+
+
+def risk_table(risky: pd.DataFrame, centres) -> pd.DataFrame:
+    """Output rows for the risky streets that have at least one cluster;
+    `centres` maps (City, Street) to that street's cluster centres."""
+    results = []
+    for street in risky.itertuples(index=False):
+        found = centres.get((street.City, street.Street))
+        if found:
+            results.append({
+                'City': street.City,
+                'Street': street.Street,
+                'Risk_level': street.Risk_level,
+                'Z_score': street.Z_score,
+                'Total_Cluster_Number_DBSCAN': len(found),
+                'Total_Accidents': street.Total_Accidents,
+                'Coordinate_Tuple': str([(float(a), float(b)) for a, b in found]),
+                'Slot_risk_levels': street.Slot_risk_levels,
+            })
+    return pd.DataFrame(results, columns=TABLE_COLUMNS)
+
+
+def run(df: pd.DataFrame, cities=None, workers=1, years=YEARS) -> pd.DataFrame:
+    rows = prepare(df, cities, years)
+    groups = group_ranges(rows)
+    streets = score_streets(groups, rows['Slot'].to_numpy())
+    coords = rows[['Latitude', 'Longitude']].to_numpy()
+
+    risky = risky_streets(streets)
+    clusters = cluster_streets(coords, list(zip(risky['start'], risky['end'])), workers)
+    return risk_table(risky, {
+        (street.City, street.Street): clusters.get((street.start, street.end))
+        for street in risky.itertuples(index=False)
+    })
+
+
+def load_accidents() -> pd.DataFrame:
+    columns = ["Metai", "address", "Latitude", "Longitude"]
+    #  Older kaza_adresli.xlsx files lack the municipality and time columns
+    available = available_columns("addressed")
+    columns += [c for c in (COL_MUNICIPALITY_RAW, COL_TIME) if c in available]
+    return load("addressed", columns=columns)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Street risk levels and DBSCAN clusters")
+    parser.add_argument("--cities", nargs="*", help="default: every municipality")
+    parser.add_argument("--output", default="k_k_v_accidents_data_lithuanian.csv")
+    parser.add_argument("--workers", type=int, default=os.cpu_count(),
+                        help="processes for the per-street DBSCAN (1 = serial)")
+    args = parser.parse_args()
+
+    result = run(load_accidents(), cities=args.cities or None, workers=args.workers)
+    result.to_csv(args.output, index=False, encoding="utf-8-sig")
+    print(f"{len(result)} risky streets in {result['City'].nunique()} cities -> {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,403 @@
+"""Incremental updates of the street risk table.
+
+A full run (risk_engine.py) re-reads and re-clusters all of 2020-2024 for
+every change. This mode keeps enough state to fold in a new batch of
+addressed accidents (a month, a year) and publish only what changed:
+
+    python code/risk_incremental.py init                   # once, from the store
+    python code/risk_incremental.py update kaza_adresli_2025_01.xlsx
+    python code/risk_incremental.py apply old.csv risk_delta_v2.json new.csv
+
+State (in --state, default risk_state/):
+  meta.json        version and per-city sufficient statistics of the street
+                   counts (n, sum, sum of squares) for mean / std
+  streets.parquet  per street: accident count, accidents per two-hour slot
+                   and cached DBSCAN centres
+  points/          accident points, bucketed by street hash and appended
+                   per version, so re-clustering one street reads one bucket
+  table.csv        the published risk table (same columns as risk_engine)
+
+An update only re-clusters streets that received new accidents. Z-scores
+of the other streets in the touched cities move with the city mean and
+std; those are recomputed from the statistics, which costs one pass over
+the street list, not over the accident history. Slot risk levels are
+recomputed from the per-street slot counts of the touched cities.
+
+Each update writes risk_delta_v<N>.json (before meta.json takes the new
+version, so a crash never leaves a version without its delta):
+  {"format": 1, "version": N, "base_version": N-1,
+   "upserts": [records in the City_Level_Street_Risk JSON shape],
+   "removals": ["City_Street", ...]}
+Rows are upserted when their level, counts or clusters change, or when the
+z-score moved by more than Z_TOLERANCE; the published table keeps the
+values that were sent, so table.csv and the app never drift apart.
+"""
+import argparse
+import ast
+import json
+import math
+import shutil
+import sys
+import zlib
+from datetime import datetime, timezone
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+import pyarrow as pa
+import pyarrow.dataset as ds
+import pyarrow.parquet as pq
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import risk_engine
+
+DELTA_FORMAT = 1
+BUCKETS = 64
+
+#  The history starts where a full run does but has no last year: batches
+#  are the accidents after it
+YEARS = (risk_engine.YEARS[0], None)
+Z_TOLERANCE = 0.005
+
+_STREET_COLUMNS = ["City", "Street", "Total_Accidents", "Slot_counts", "Centres"]
+
+
+def street_id(city, street) -> str:
+    #  Same key as RiskMap.id in the app
+    return f"{city}_{street}"
+
+
+def _bucket(city, street) -> int:
+    return zlib.crc32(street_id(city, street).encode("utf-8")) % BUCKETS
+
+
+def _encode_centres(centres) -> str:
+    return json.dumps([[float(a), float(b)] for a, b in centres]) if centres else ""
+
+
+def _decode_centres(text):
+    return [tuple(p) for p in json.loads(text)] if text else []
+
+
+def _encode_slots(counts) -> str:
+    return json.dumps([int(c) for c in counts])
+
+
+def _decode_slots(text):
+    return json.loads(text) if isinstance(text, str) and text else [0] * risk_engine.SLOTS
+
+
+def _slot_levels(value) -> list:
+    #  CSV'den okunan boş hücre NaN gelir
+    return ast.literal_eval(value) if isinstance(value, str) and value else []
+
+
+def _record(row) -> dict:
+    """Table row -> record in the JSON shape script 5 writes."""
+    return {
+        "City": row["City"],
+        "Street": row["Street"],
+        "Risk_level": row["Risk_level"],
+        "Z_score": float(row["Z_score"]),
+        "Total_Cluster_Number_DBSCAN": int(row["Total_Cluster_Number_DBSCAN"]),
+        "Total_Accidents": int(row["Total_Accidents"]),
+        "Coordinate_Tuple": [[float(a), float(b)] for a, b in ast.literal_eval(row["Coordinate_Tuple"])],
+        "Slot_risk_levels": _slot_levels(row["Slot_risk_levels"]),
+    }
+
+
+class RiskState:
+    def __init__(self, root):
+        self.root = Path(root)
+
+    # ---- storage -------------------------------------------------------
+
+    def _read_meta(self):
+        return json.loads((self.root / "meta.json").read_text(encoding="utf-8"))
+
+    def _write_meta(self, meta):
+        tmp = self.root / "meta.json.tmp"
+        tmp.write_text(json.dumps(meta, ensure_ascii=False, indent=1), encoding="utf-8")
+        tmp.replace(self.root / "meta.json")
+
+    def _read_streets(self) -> pd.DataFrame:
+        streets = pd.read_parquet(self.root / "streets.parquet")
+        if "Slot_counts" not in streets.columns:  # state from before slot levels
+            streets["Slot_counts"] = ""
+        return streets
+
+    def _write_streets(self, streets: pd.DataFrame):
+        tmp = self.root / "streets.parquet.tmp"
+        streets[_STREET_COLUMNS].to_parquet(tmp, index=False)
+        tmp.replace(self.root / "streets.parquet")
+
+    def read_table(self) -> pd.DataFrame:
+        table = pd.read_csv(self.root / "table.csv", encoding="utf-8-sig", float_precision="round_trip")
+        return table.reindex(columns=risk_engine.TABLE_COLUMNS)
+
+    def _write_table(self, table: pd.DataFrame):
+        tmp = self.root / "table.csv.tmp"
+        table.to_csv(tmp, index=False, encoding="utf-8-sig")
+        tmp.replace(self.root / "table.csv")
+
+    def _append_points(self, rows: pd.DataFrame, version: int):
+        points = rows[["City", "Street", "Latitude", "Longitude"]].copy()
+        points["bucket"] = [_bucket(c, s) for c, s in zip(points["City"], points["Street"])]
+        pq.write_to_dataset(
+            pa.Table.from_pandas(points, preserve_index=False),
+            self.root / "points",
+            partition_cols=["bucket"],
+            basename_template=f"part-{version:06d}-{{i}}.parquet",
+        )
+
+    def _read_points(self, keys) -> pd.DataFrame:
+        """Points of the (City, Street) `keys`, in the order they arrived."""
+        buckets = sorted({_bucket(c, s) for c, s in keys})
+        dataset = ds.dataset(self.root / "points", format="parquet", partitioning="hive")
+        table = dataset.to_table(
+            columns=["City", "Street", "Latitude", "Longitude"],
+            filter=ds.field("bucket").isin(buckets),
+        )
+        points = table.to_pandas()
+        wanted = pd.MultiIndex.from_tuples(list(keys), names=["City", "Street"])
+        mask = pd.MultiIndex.from_arrays([points["City"], points["Street"]]).isin(wanted)
+        return points[mask]
+
+    # ---- scoring -------------------------------------------------------
+
+    @staticmethod
+    def _city_stats(counts: pd.Series):
+        c = counts.astype(object)
+        return [len(c), int(c.sum()), int((c * c).sum())]
+
+    @staticmethod
+    def _score(streets: pd.DataFrame, stats) -> pd.DataFrame:
+        """Z_score / Risk_level from the per-city statistics (pandas std,
+        ddof=1)."""
+        z = np.full(len(streets), np.nan)
+        for i, (city, count) in enumerate(zip(streets["City"], streets["Total_Accidents"])):
+            n, s, ss = stats[city]
+            if n > 1:
+                var = (ss - s * s / n) / (n - 1)
+                if var > 0:
+                    z[i] = (count - s / n) / math.sqrt(var)
+        streets = streets.copy()
+        streets["Z_score"] = z
+        streets["Risk_level"] = streets["Z_score"].map(risk_engine.risk_level)
+        counts = np.array([_decode_slots(c) for c in streets["Slot_counts"]], dtype=np.int64)
+        streets["Slot_risk_levels"] = risk_engine.slot_levels(
+            streets["City"], counts.reshape(len(streets), risk_engine.SLOTS))
+        return streets
+
+    @staticmethod
+    def _table_for(streets: pd.DataFrame) -> pd.DataFrame:
+        risky = risk_engine.risky_streets(streets)
+        centres = {
+            (c, s): _decode_centres(e)
+            for c, s, e in zip(risky["City"], risky["Street"], risky["Centres"])
+        }
+        return risk_engine.risk_table(risky, centres)
+
+    @staticmethod
+    def _cluster(points: pd.DataFrame, workers):
+        """Cached centres for every street in `points` (already grouped)."""
+        points = points.sort_values(["City", "Street"], kind="stable").reset_index(drop=True)
+        groups = risk_engine.group_ranges(points)
+        coords = points[["Latitude", "Longitude"]].to_numpy()
+        clusters = risk_engine.cluster_streets(coords, [(s, e) for _, _, s, e in groups], workers)
+        return {(c, st): _encode_centres(clusters.get((s, e))) for c, st, s, e in groups}
+
+    # ---- operations ----------------------------------------------------
+
+    def init(self, accidents: pd.DataFrame, workers=1) -> pd.DataFrame:
+        """Builds the state from the full history and publishes version 1."""
+        shutil.rmtree(self.root, ignore_errors=True)
+        self.root.mkdir(parents=True)
+        rows = risk_engine.prepare(accidents, years=YEARS)
+        self._append_points(rows, 1)
+
+        groups = risk_engine.group_ranges(rows)
+        streets = pd.DataFrame(
+            [(c, s, e - b) for c, s, b, e in groups],
+            columns=["City", "Street", "Total_Accidents"],
+        )
+        slots = risk_engine.slot_counts(rows["Slot"].to_numpy(), groups)
+        streets["Slot_counts"] = [_encode_slots(c) for c in slots]
+        #  Every street is clustered once, so a later change of risk level
+        #  never needs its points again
+        centres = self._cluster(rows, workers)
+        streets["Centres"] = [centres[(c, s)] for c, s in zip(streets["City"], streets["Street"])]
+
+        stats = {
+            city: self._city_stats(group["Total_Accidents"])
+            for city, group in streets.groupby("City")
+        }
+        table = self._table_for(self._score(streets, stats))
+        self._write_streets(streets)
+        self._write_table(table)
+        self._write_meta({"version": 1, "cities": stats})
+        return table
+
+    def update(self, batch: pd.DataFrame, workers=1, delta_dir=None):
+        """Folds `batch` (addressed accidents) in. Returns (delta, table);
+        the delta is also written to `delta_dir` when one is given."""
+        meta = self._read_meta()
+        version = meta["version"] + 1
+        stats = {city: list(v) for city, v in meta["cities"].items()}
+
+        rows = risk_engine.prepare(batch, years=YEARS)
+        added = rows.groupby(["City", "Street"], sort=False).size()
+        if added.empty:
+            return None, self.read_table()
+        #  prepare() sıralı döndürüyor: gruplar `added` ile aynı sırada
+        added_slots = risk_engine.slot_counts(rows["Slot"].to_numpy(), risk_engine.group_ranges(rows))
+
+        streets = self._read_streets().set_index(["City", "Street"])
+        for (city, street), n_new in added.items():
+            n, s, ss = stats.get(city, [0, 0, 0])
+            old = int(streets.at[(city, street), "Total_Accidents"]) if (city, street) in streets.index else 0
+            if old == 0:
+                n += 1
+            stats[city] = [n, s + n_new, ss + (old + n_new) ** 2 - old * old]
+
+        new_keys = [k for k in added.index if k not in streets.index]
+        if new_keys:
+            streets = pd.concat([streets, pd.DataFrame(
+                {"Total_Accidents": 0, "Slot_counts": "", "Centres": ""},
+                index=pd.MultiIndex.from_tuples(new_keys, names=["City", "Street"]),
+            )])
+        streets.loc[added.index, "Total_Accidents"] = (
+            streets.loc[added.index, "Total_Accidents"].to_numpy() + added.to_numpy()
+        )
+        streets.loc[added.index, "Slot_counts"] = [
+            _encode_slots(np.add(_decode_slots(old), new))
+            for old, new in zip(streets.loc[added.index, "Slot_counts"], added_slots)
+        ]
+
+        #  Only streets whose accident set changed are re-clustered
+        self._append_points(rows, version)
+        centres = self._cluster(self._read_points(list(added.index)), workers)
+        streets.loc[list(centres), "Centres"] = list(centres.values())
+        streets = streets.reset_index()
+
+        touched = set(added.index.get_level_values("City"))
+        scored = self._score(streets[streets["City"].isin(touched)], stats)
+        fresh = self._table_for(scored)
+
+        table = self.read_table()
+        delta, table = self._diff(table, fresh, touched, version)
+        self._write_streets(streets)
+        self._write_table(table)
+        if delta_dir is not None:
+            write_delta(delta, delta_dir)
+        meta["version"] = version
+        meta["cities"] = stats
+        self._write_meta(meta)
+        return delta, table
+
+    @staticmethod
+    def _diff(table, fresh, touched, version):
+        old = table[table["City"].isin(touched)]
+        old_by_id = {street_id(r["City"], r["Street"]): r for _, r in old.iterrows()}
+        fresh_by_id = {street_id(r["City"], r["Street"]): r for _, r in fresh.iterrows()}
+
+        upserts, kept = [], []
+        for key, row in fresh_by_id.items():
+            prev = old_by_id.get(key)
+            if prev is not None and _same(prev, row):
+                kept.append(prev)
+            else:
+                upserts.append(row)
+        removals = sorted(set(old_by_id) - set(fresh_by_id))
+
+        untouched = table[~table["City"].isin(touched)]
+        table = pd.concat(
+            [untouched, pd.DataFrame(kept + upserts, columns=risk_engine.TABLE_COLUMNS)],
+            ignore_index=True,
+        ).sort_values(["City", "Street"], kind="stable").reset_index(drop=True)
+
+        delta = {
+            "format": DELTA_FORMAT,
+            "version": version,
+            "base_version": version - 1,
+            "generated": datetime.now(timezone.utc).isoformat(timespec="seconds"),
+            "upserts": [_record(r) for r in upserts],
+            "removals": removals,
+        }
+        return delta, table
+
+
+def _same(old, new) -> bool:
+    return (
+        old["Risk_level"] == new["Risk_level"]
+        and int(old["Total_Accidents"]) == int(new["Total_Accidents"])
+        and int(old["Total_Cluster_Number_DBSCAN"]) == int(new["Total_Cluster_Number_DBSCAN"])
+        and ast.literal_eval(old["Coordinate_Tuple"]) == ast.literal_eval(new["Coordinate_Tuple"])
+        and abs(float(old["Z_score"]) - float(new["Z_score"])) <= Z_TOLERANCE
+        and _slot_levels(old["Slot_risk_levels"]) == _slot_levels(new["Slot_risk_levels"])
+    )
+
+
+def write_delta(delta: dict, directory) -> Path:
+    out = Path(directory) / f"risk_delta_v{delta['version']}.json"
+    tmp = out.with_name(out.name + ".tmp")
+    tmp.write_text(json.dumps(delta, ensure_ascii=False, indent=1), encoding="utf-8")
+    tmp.replace(out)
+    return out
+
+
+def apply_delta(table: pd.DataFrame, delta: dict) -> pd.DataFrame:
+    """Applies a delta to a risk table in the risk_engine / CSV layout."""
+    drop = set(delta["removals"]) | {street_id(r["City"], r["Street"]) for r in delta["upserts"]}
+    ids = [street_id(c, s) for c, s in zip(table["City"], table["Street"])]
+    kept = table[[i not in drop for i in ids]]
+    upserts = pd.DataFrame([
+        {**r, "Coordinate_Tuple": str([(float(a), float(b)) for a, b in r["Coordinate_Tuple"]]),
+         "Slot_risk_levels": str(r["Slot_risk_levels"]) if r.get("Slot_risk_levels") else ""}
+        for r in delta["upserts"]
+    ], columns=risk_engine.TABLE_COLUMNS)
+    return (
+        pd.concat([kept, upserts], ignore_index=True)
+        .sort_values(["City", "Street"], kind="stable")
+        .reset_index(drop=True)
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Incremental street risk updates")
+    parser.add_argument("--state", default="risk_state")
+    parser.add_argument("--workers", type=int, default=1)
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("init", help="build the state from the accident store")
+    p = sub.add_parser("update", help="fold in a batch of addressed accidents")
+    p.add_argument("batch", help="xlsx/csv with Metai, address, Latitude, Longitude (and Laikas)")
+    p.add_argument("--delta-dir", default=".")
+    p = sub.add_parser("apply", help="apply a delta to a risk table CSV")
+    p.add_argument("table")
+    p.add_argument("delta")
+    p.add_argument("output")
+    args = parser.parse_args()
+
+    state = RiskState(args.state)
+    if args.command == "init":
+        table = state.init(risk_engine.load_accidents(), workers=args.workers)
+        print(f"[OK] version 1: {len(table)} risky streets -> {state.root / 'table.csv'}")
+    elif args.command == "update":
+        path = Path(args.batch)
+        batch = pd.read_csv(path) if path.suffix.lower() == ".csv" else pd.read_excel(path)
+        delta, table = state.update(batch, workers=args.workers, delta_dir=args.delta_dir)
+        if delta is None:
+            print("Nothing to update")
+            return
+        out = Path(args.delta_dir) / f"risk_delta_v{delta['version']}.json"
+        print(f"[OK] version {delta['version']}: {len(delta['upserts'])} upserts, "
+              f"{len(delta['removals'])} removals -> {out}")
+    else:
+        table = pd.read_csv(args.table, encoding="utf-8-sig")
+        delta = json.loads(Path(args.delta).read_text(encoding="utf-8"))
+        apply_delta(table, delta).to_csv(args.output, index=False, encoding="utf-8-sig")
+        print(f"[OK] {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,52 @@
+"""Local stand-in for the risk delta server.
+
+Serves the risk_delta_v<N>.json files written by
+`risk_incremental.py update --delta-dir <dir>` over plain HTTP, which is
+all the app's RiskMapUpdater needs: it asks for v<N+1> until it gets 404.
+
+    python code/serve_risk_deltas.py --dir deltas --port 8765
+    flutter run --dart-define=RISK_DELTA_URL=http://10.0.2.2:8765/
+
+(10.0.2.2 is the host machine as seen from the Android emulator.)
+"""
+import argparse
+import functools
+import re
+from http.server import SimpleHTTPRequestHandler, ThreadingHTTPServer
+
+DELTA_NAME = re.compile(r"^/risk_delta_v\d+\.json$")
+
+
+class DeltaHandler(SimpleHTTPRequestHandler):
+    def do_GET(self):
+        # Sadece delta dosyaları; dizin listesi vs. yok
+        if not DELTA_NAME.match(self.path):
+            self.send_error(404)
+            return
+        super().do_GET()
+
+    def do_HEAD(self):
+        if not DELTA_NAME.match(self.path):
+            self.send_error(404)
+            return
+        super().do_HEAD()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Serve risk deltas for the app")
+    parser.add_argument("--dir", default=".", help="directory with risk_delta_v*.json")
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8765)
+    args = parser.parse_args()
+
+    handler = functools.partial(DeltaHandler, directory=args.dir)
+    server = ThreadingHTTPServer((args.host, args.port), handler)
+    print(f"Serving {args.dir} on http://{args.host}:{args.port}/")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,282 @@
+"""Attaches road geometry from a local OSM extract to the risk table.
+
+Each DBSCAN centre of a street is snapped to the nearest drivable OSM way,
+preferring ways whose name matches the street, and the stretch of that way
+within SEGMENT_EXTENT metres either side of the snapped point is kept.
+Overlapping stretches of one street are merged, simplified and written to
+a "Segments" column ([[[lat, lon], ...], ...] as JSON), which script 6
+packs into the risk map so the app measures distance to the road instead
+of to the centroids.
+
+    python code/snap_clusters_to_osm.py k_k_v_accidents_data_lithuanian.csv \\
+        lithuania.osm.bz2 --output k_k_v_accidents_with_segments.csv
+
+The extract is OSM XML (.osm, .osm.bz2 or .osm.gz); a .pbf from Geofabrik
+converts with `osmium cat lithuania-latest.osm.pbf -o lithuania.osm.bz2`.
+Centres with no way within SNAP_METERS stay unsnapped and the app keeps
+using them as points.
+"""
+import argparse
+import ast
+import bz2
+import gzip
+import json
+import re
+import unicodedata
+import xml.etree.ElementTree as ET
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+from pyproj import Transformer
+from scipy.spatial import cKDTree
+
+SNAP_METERS = 40
+#  Half the DBSCAN eps: a cluster spans about one eps along the road
+SEGMENT_EXTENT = 100
+SIMPLIFY_METERS = 3
+
+HIGHWAYS = {
+    "motorway", "trunk", "primary", "secondary", "tertiary", "unclassified",
+    "residential", "living_street", "service", "road",
+    "motorway_link", "trunk_link", "primary_link", "secondary_link", "tertiary_link",
+}
+
+#  Sokak tipi son ekleri, isim karşılaştırmasından önce atılıyor
+_STREET_TYPES = {
+    "g", "gatve", "pr", "prospektas", "al", "aleja", "pl", "plentas",
+    "kel", "kelias", "skg", "skersgatvis", "tak", "takas", "a", "aikste",
+}
+
+_to_metres = None
+_to_wgs84 = None
+
+
+def _transformers():
+    #  LKS94 is metric and conformal over Lithuania, so lengths along the
+    #  way and snap distances are plain Euclidean
+    global _to_metres, _to_wgs84
+    if _to_metres is None:
+        _to_metres = Transformer.from_crs("EPSG:4326", "EPSG:3346", always_xy=True)
+        _to_wgs84 = Transformer.from_crs("EPSG:3346", "EPSG:4326", always_xy=True)
+    return _to_metres, _to_wgs84
+
+
+def name_key(name) -> str:
+    """'Savanorių pr.' and 'Savanorių prospektas' -> 'savanoriu'."""
+    if name is None or pd.isna(name):
+        return ""
+    text = unicodedata.normalize("NFKD", str(name).lower())
+    text = "".join(ch for ch in text if not unicodedata.combining(ch))
+    words = re.findall(r"\w+", text)
+    while words and words[-1] in _STREET_TYPES:
+        words.pop()
+    return " ".join(words)
+
+
+def _open(path: Path):
+    if path.suffix == ".bz2":
+        return bz2.open(path, "rb")
+    if path.suffix == ".gz":
+        return gzip.open(path, "rb")
+    return path.open("rb")
+
+
+def read_ways(path):
+    """Drivable ways of an OSM XML extract as [(name_key, lat[], lon[])].
+
+    Two passes: ways first (to know which nodes matter), then only those
+    nodes' coordinates, so a country extract does not need every node in
+    memory."""
+    path = Path(path)
+    ways = []
+    with _open(path) as f:
+        for _, elem in ET.iterparse(f, events=("end",)):
+            if elem.tag == "way":
+                tags = {t.get("k"): t.get("v") for t in elem.iter("tag")}
+                if tags.get("highway") in HIGHWAYS:
+                    refs = [int(nd.get("ref")) for nd in elem.iter("nd")]
+                    if len(refs) >= 2:
+                        ways.append((name_key(tags.get("name")), refs))
+                elem.clear()
+            elif elem.tag in ("node", "relation"):
+                elem.clear()
+
+    needed = {r for _, refs in ways for r in refs}
+    coords = {}
+    with _open(path) as f:
+        for _, elem in ET.iterparse(f, events=("end",)):
+            if elem.tag == "node":
+                node_id = int(elem.get("id"))
+                if node_id in needed:
+                    coords[node_id] = (float(elem.get("lat")), float(elem.get("lon")))
+            if elem.tag in ("node", "way", "relation"):
+                elem.clear()
+
+    result = []
+    for key, refs in ways:
+        points = [coords[r] for r in refs if r in coords]
+        if len(points) >= 2:
+            lat, lon = zip(*points)
+            result.append((key, np.array(lat), np.array(lon)))
+    return result
+
+
+class WayIndex:
+    """All way segments in LKS94 metres, with a KD-tree on their midpoints."""
+
+    def __init__(self, ways):
+        to_metres, _ = _transformers()
+        self.names = [key for key, _, _ in ways]
+        self.xy = []
+        self.cumlen = []
+        seg_way, seg_i = [], []
+        for w, (_, lat, lon) in enumerate(ways):
+            x, y = to_metres.transform(lon, lat)
+            xy = np.column_stack((x, y))
+            steps = np.hypot(*np.diff(xy, axis=0).T)
+            self.xy.append(xy)
+            self.cumlen.append(np.concatenate(([0.0], np.cumsum(steps))))
+            seg_way.append(np.full(len(xy) - 1, w))
+            seg_i.append(np.arange(len(xy) - 1))
+        self.seg_way = np.concatenate(seg_way)
+        self.seg_i = np.concatenate(seg_i)
+        a = np.concatenate([xy[:-1] for xy in self.xy])
+        b = np.concatenate([xy[1:] for xy in self.xy])
+        self.a, self.b = a, b
+        self.tree = cKDTree((a + b) / 2)
+        self.half_max = float(np.hypot(*(b - a).T).max() / 2)
+
+    def snap(self, x, y, street_key, radius=SNAP_METERS):
+        """(way, arc length along it) of the best snap of (x, y), or None."""
+        candidates = np.array(self.tree.query_ball_point((x, y), radius + self.half_max), dtype=np.int64)
+        if len(candidates) == 0:
+            return None
+        a, b = self.a[candidates], self.b[candidates]
+        ab = b - a
+        denom = np.maximum((ab * ab).sum(axis=1), 1e-12)
+        t = np.clip(((np.array([x, y]) - a) * ab).sum(axis=1) / denom, 0.0, 1.0)
+        proj = a + t[:, None] * ab
+        dist = np.hypot(proj[:, 0] - x, proj[:, 1] - y)
+        ok = dist <= radius
+        if not ok.any():
+            return None
+        #  Aynı isimli yol varsa onu tercih et
+        named = ok & np.array([self.names[w] == street_key for w in self.seg_way[candidates]])
+        pick = named if (street_key and named.any()) else ok
+        k = np.flatnonzero(pick)[np.argmin(dist[pick])]
+        seg = candidates[k]
+        way = int(self.seg_way[seg])
+        i = int(self.seg_i[seg])
+        length = self.cumlen[way][i] + t[k] * (self.cumlen[way][i + 1] - self.cumlen[way][i])
+        return way, float(length)
+
+    def stretch(self, way, start, end):
+        """Polyline of `way` between arc lengths start and end, in metres."""
+        cum, xy = self.cumlen[way], self.xy[way]
+        start, end = max(start, 0.0), min(end, cum[-1])
+        inner = np.flatnonzero((cum > start) & (cum < end))
+        ends = [np.array([np.interp(s, cum, xy[:, 0]), np.interp(s, cum, xy[:, 1])]) for s in (start, end)]
+        return np.vstack([ends[0], xy[inner], ends[1]])
+
+
+def simplify(xy, tolerance=SIMPLIFY_METERS):
+    """Douglas-Peucker; keeps the end points."""
+    if len(xy) <= 2:
+        return xy
+    keep = np.zeros(len(xy), dtype=bool)
+    keep[[0, -1]] = True
+    stack = [(0, len(xy) - 1)]
+    while stack:
+        i, j = stack.pop()
+        if j <= i + 1:
+            continue
+        a, b = xy[i], xy[j]
+        ab = b - a
+        pts = xy[i + 1:j] - a
+        norm = np.hypot(*ab)
+        if norm == 0:
+            d = np.hypot(pts[:, 0], pts[:, 1])
+        else:
+            d = np.abs(ab[0] * pts[:, 1] - ab[1] * pts[:, 0]) / norm
+        k = int(np.argmax(d))
+        if d[k] > tolerance:
+            keep[i + 1 + k] = True
+            stack += [(i, i + 1 + k), (i + 1 + k, j)]
+    return xy[keep]
+
+
+def _centres(value):
+    if isinstance(value, str):
+        try:
+            value = ast.literal_eval(value)
+        except (ValueError, SyntaxError):
+            return []
+    return [(float(a), float(b)) for a, b in value] if isinstance(value, (list, tuple)) else []
+
+
+def street_segments(index: WayIndex, street, centres):
+    """Merged, simplified polylines (lat/lon lists) for one street."""
+    if not centres:
+        return []
+    to_metres, to_wgs84 = _transformers()
+    lat, lon = np.array(centres).T
+    x, y = to_metres.transform(lon, lat)
+    key = name_key(street)
+
+    intervals = {}
+    for cx, cy in zip(x, y):
+        snapped = index.snap(cx, cy, key)
+        if snapped is not None:
+            way, s = snapped
+            intervals.setdefault(way, []).append((s - SEGMENT_EXTENT, s + SEGMENT_EXTENT))
+
+    polylines = []
+    for way, spans in intervals.items():
+        spans.sort()
+        merged = [list(spans[0])]
+        for s, e in spans[1:]:
+            if s <= merged[-1][1]:
+                merged[-1][1] = max(merged[-1][1], e)
+            else:
+                merged.append([s, e])
+        for s, e in merged:
+            xy = simplify(index.stretch(way, s, e))
+            plon, plat = to_wgs84.transform(xy[:, 0], xy[:, 1])
+            polylines.append([[round(float(a), 6), round(float(b), 6)] for a, b in zip(plat, plon)])
+    return polylines
+
+
+def snap_table(table: pd.DataFrame, ways) -> pd.DataFrame:
+    index = WayIndex(ways)
+    out = table.copy()
+    out["Segments"] = [
+        json.dumps(street_segments(index, s, _centres(c)))
+        for s, c in zip(table["Street"], table["Coordinate_Tuple"])
+    ]
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Snap risk clusters to OSM road segments")
+    parser.add_argument("table", help="risk table CSV (risk_engine.py / scripts 3-4 output)")
+    parser.add_argument("osm", help="OSM XML extract (.osm, .osm.bz2, .osm.gz)")
+    parser.add_argument("--output", default="k_k_v_accidents_with_segments.csv")
+    args = parser.parse_args()
+
+    table = pd.read_csv(args.table, encoding="utf-8-sig")
+    ways = read_ways(args.osm)
+    print(f"{len(ways)} drivable ways read from {args.osm}")
+    out = snap_table(table, ways)
+
+    segments = [json.loads(s) for s in out["Segments"]]
+    snapped = sum(1 for s in segments if s)
+    vertices = sum(len(p) for s in segments for p in s)
+    centres = sum(len(_centres(c)) for c in table["Coordinate_Tuple"])
+    out.to_csv(args.output, index=False, encoding="utf-8-sig")
+    print(f"[OK] {snapped}/{len(out)} streets snapped, {vertices} polyline vertices "
+          f"for {centres} cluster centres -> {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,214 @@
+"""Street (and municipality) names from geocoded addresses, memoised on disk.
+
+The same Nominatim string repeats for every accident at that spot, so the
+addresses are factorised first and the rules only ever see the unique set,
+once, through a vectorised `str.extract`. The resulting address ->
+(City, Street) mapping is kept under `<STORE_ROOT>/street_cache/`, so a
+later run only extracts addresses it has never seen:
+
+    from street_normalizer import streets
+    df["Street"] = streets(df["address"])                 # risk rule
+    df["Street"] = streets(df["address"], rule="figure")  # Fig.2/15/16
+
+Two rules exist because the figures and the risk scripts always differed:
+
+- "risk" (scripts 3/4, risk_engine, Fig.7-9): the suffix regex, else the
+  first comma part containing a street suffix, else the third comma part,
+  else "Bilinmeyen".
+- "figure" (Fig.2/15/16): a stricter regex, else the second comma part,
+  else the whole address.
+
+Missing addresses give None under both rules.
+
+The cache file name carries a fingerprint of the rule, so editing a
+pattern starts a fresh cache instead of serving stale names.
+"""
+import os
+import re
+import sys
+import zlib
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+from accident_store import STORE_ROOT
+
+UNKNOWN_STREET = "Bilinmeyen"
+
+_SUFFIXES = r"g\.|pl\.|pr\.|kel\.|al\.|gatvė|prospektas|kelias|alėja"
+#  Sokak adı için scripts 3/4 ile aynı regex ve yedek kural
+STREET_PATTERN = r'(\b[\wÀ-ž\s\-\.]+?\s?(' + _SUFFIXES + r'))'
+FIGURE_STREET_PATTERN = r"([\wÀ-ž\.\- ]+?\s(?:" + _SUFFIXES + r"))"
+_STREET_SUFFIX = re.compile(r'\b(?:' + _SUFFIXES + r')\b', re.IGNORECASE)
+
+#  Kurallardan biri değişirse artırılır (önbellek dosyası da değişir)
+_RULE_VERSION = 1
+
+#  City municipalities in the forms they appear in: the police export
+#  ("Vilniaus m. sav."), Nominatim in Lithuanian ("Vilniaus miesto
+#  savivaldybė") and in English ("Vilnius city municipality")
+CITY_MUNICIPALITIES = {
+    "Vilnius": ("vilniaus m", "vilnius city"),
+    "Kaunas": ("kauno m", "kaunas city"),
+    "Klaipėda": ("klaipėdos m", "klaipėda city", "klaipeda city"),
+    "Šiauliai": ("šiaulių m", "šiauliai city"),
+    "Panevėžys": ("panevėžio m", "panevėžys city"),
+    "Alytus": ("alytaus m", "alytus city"),
+}
+_MUNICIPALITY_WORDS = ("savivaldybė", "municipality", " sav.")
+
+
+def normalize_municipality(text):
+    if text is None or pd.isna(text):
+        return None
+    t = str(text).strip()
+    lower = t.lower()
+    for city, prefixes in CITY_MUNICIPALITIES.items():
+        if lower.startswith(prefixes):
+            return city
+    return t
+
+
+def municipality_from_address(address):
+    """The municipality component of a Nominatim address, if any."""
+    if address is None or pd.isna(address):
+        return None
+    for part in str(address).split(","):
+        if any(w in part.lower() for w in _MUNICIPALITY_WORDS):
+            return normalize_municipality(part)
+    return None
+
+
+def backup_street(parts, existing):
+    """Per-row fallback of the risk rule, kept for callers that already
+    hold split addresses."""
+    if existing != UNKNOWN_STREET:
+        return existing
+    for p in parts:
+        if _STREET_SUFFIX.search(p.strip()):
+            return p.strip()
+    return parts[2].strip() if len(parts) >= 3 else UNKNOWN_STREET
+
+
+def _risk_streets(addresses: pd.Series) -> pd.Series:
+    found = addresses.str.extract(STREET_PATTERN, expand=False)[0]
+    missing = found.isna()
+    if not missing.any():
+        return found
+    rest = addresses[missing]
+    parts = rest.str.split(",")
+    # İlk soneki olan parça, yoksa üçüncü parça
+    pieces = parts.explode().str.strip()
+    with_suffix = pieces[pieces.str.contains(_STREET_SUFFIX.pattern, flags=re.IGNORECASE)]
+    first = with_suffix.groupby(level=0, sort=False).first()
+    third = parts.str[2].str.strip()
+    found[missing] = first.reindex(rest.index).fillna(third).fillna(UNKNOWN_STREET)
+    return found
+
+
+def _figure_streets(addresses: pd.Series) -> pd.Series:
+    found = addresses.str.extract(FIGURE_STREET_PATTERN, expand=False).str.strip()
+    missing = found.isna()
+    if missing.any():
+        rest = addresses[missing]
+        second = rest.str.split(",").str[1].str.strip()
+        found[missing] = second.fillna(rest.str.strip())
+    return found
+
+
+RULES = {"risk": (STREET_PATTERN, _risk_streets), "figure": (FIGURE_STREET_PATTERN, _figure_streets)}
+
+
+def _fingerprint(rule):
+    text = f"{_RULE_VERSION}|{RULES[rule][0]}|{_STREET_SUFFIX.pattern}"
+    return f"{zlib.crc32(text.encode('utf-8')):08x}"
+
+
+def cache_path(rule):
+    return STORE_ROOT / "street_cache" / f"{rule}-{_fingerprint(rule)}.parquet"
+
+
+class StreetNormalizer:
+    """Address -> (City, Street) for one rule, memoised in memory and, when
+    `path` is set, in a Parquet file."""
+
+    def __init__(self, rule="risk", path=None):
+        if rule not in RULES:
+            raise ValueError(f"unknown street rule {rule!r} (expected one of {sorted(RULES)})")
+        self.rule = rule
+        self.path = Path(path) if path is not None else None
+        self.extracted = 0
+        self._addresses = None
+        self._city = None
+        self._street = None
+
+    def _load(self):
+        if self._addresses is not None:
+            return
+        if self.path is not None and self.path.exists():
+            table = pd.read_parquet(self.path)
+            self._addresses = pd.Index(table["address"].to_numpy(dtype=object))
+            self._city = table["City"].astype(object).where(table["City"].notna(), None).to_numpy()
+            self._street = table["Street"].to_numpy(dtype=object)
+        else:
+            self._addresses = pd.Index([], dtype=object)
+            self._city = np.empty(0, dtype=object)
+            self._street = np.empty(0, dtype=object)
+
+    def _save(self):
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        # Paralel figür işçileri aynı dosyayı yazabilir
+        tmp = self.path.with_name(f"{self.path.name}.{os.getpid()}.tmp")
+        pd.DataFrame({
+            "address": self._addresses.to_numpy(dtype=object),
+            "City": self._city,
+            "Street": self._street,
+        }).to_parquet(tmp, index=False)
+        tmp.replace(self.path)
+
+    def lookup(self, addresses) -> tuple:
+        """(city, street) object arrays aligned with `addresses`; missing
+        addresses give None for both."""
+        self._load()
+        codes, uniques = pd.factorize(pd.Series(addresses, dtype=object), use_na_sentinel=True)
+        uniques = pd.Index(uniques, dtype=object)
+
+        where = self._addresses.get_indexer(uniques)
+        new = where < 0
+        if new.any():
+            fresh = pd.Series(uniques[new].to_numpy(dtype=object), dtype=str)
+            street = RULES[self.rule][1](fresh).to_numpy(dtype=object)
+            city = np.array([municipality_from_address(a) for a in fresh], dtype=object)
+            where[new] = len(self._addresses) + np.arange(int(new.sum()))
+            self._addresses = self._addresses.append(pd.Index(fresh.to_numpy(dtype=object)))
+            self._city = np.concatenate([self._city, city])
+            self._street = np.concatenate([self._street, street])
+            self.extracted += len(fresh)
+            if self.path is not None:
+                self._save()
+
+        # -1 (eksik adres) için sona bir None ekleniyor
+        city = np.append(self._city[where], None)[codes]
+        street = np.append(self._street[where], None)[codes]
+        return city, street
+
+
+_normalizers = {}
+
+
+def normalizer(rule="risk"):
+    """The process-wide normalizer of `rule`, backed by the store cache."""
+    if rule not in _normalizers:
+        _normalizers[rule] = StreetNormalizer(rule, cache_path(rule) if rule in RULES else None)
+    return _normalizers[rule]
+
+
+def streets(addresses, rule="risk") -> np.ndarray:
+    return normalizer(rule).lookup(addresses)[1]
+
+
+def cities(addresses) -> np.ndarray:
+    """Municipality of each address, see `municipality_from_address`."""
+    return normalizer("risk").lookup(addresses)[0]
@@ -0,0 +1,241 @@
+"""Accident counts pre-aggregated over year, month, weekday, hour, city and street.
+
+Fig.1 and Fig.11 rebuilt the hour of every accident from the raw rows,
+and Fig.2/15/16 regrouped the addressed rows by year and street on every
+run. The store now keeps one cube per dataset, `<STORE_ROOT>/cube/<name>.parquet`.
+It holds one row per distinct dimension tuple with its `Count`, and every
+time and trend question is a filter plus a group-by over that:
+
+    from temporal_cube import counts
+    counts("raw", "Hour")                                    # Fig.1
+    counts("raw", "Hour", Metai=2024)                        # Fig.11
+    counts("addressed", ["Metai", "FigureStreet"], AddressCity="Klaipėda",
+           Metai=range(2020, 2025))                          # Fig.2/15/16
+
+Dimensions:
+- Hour: from Laikas. The store already turns both Laikas encodings (Excel
+  time numbers and "HH:MM:SS" strings) into a day fraction.
+- Month and Weekday (1 = Monday): from the first DATE_COLUMNS column the
+  dataset has.
+- City: the normalised municipality, from the police column or, failing
+  that, from the address.
+- Street: the risk-rule street of street_normalizer.
+- FigureStreet: the figure-rule street, which Fig.2/15/16 always used.
+- AddressCity: the first ADDRESS_CITIES name whose pattern occurs in the
+  address (case-insensitive). This is the filter of Fig.2/15/16, which is
+  wider than City: "Klaipėda County" addresses match too.
+
+A dimension the dataset cannot provide is -1 (numbers) or null (names).
+
+`accident_store.ingest` refreshes the cube. The cube remembers a content
+fingerprint per year partition, so a re-ingest only re-aggregates years
+whose rows changed. A cube written with other dimensions (CUBE_VERSION)
+is rebuilt.
+"""
+import json
+import os
+import re
+import sys
+from functools import lru_cache
+from pathlib import Path
+
+import numpy as np
+import pandas as pd
+import pyarrow as pa
+import pyarrow.dataset as ds
+import pyarrow.parquet as pq
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import accident_store
+from accident_store import COL_MUNICIPALITY_RAW, COL_TIME, COL_YEAR, STORE_ROOT
+from street_normalizer import normalize_municipality, normalizer
+
+DIMENSIONS = ("Metai", "Month", "Weekday", "Hour", "City", "Street", "FigureStreet", "AddressCity")
+UNKNOWN = -1
+CUBE_VERSION = 2
+
+#  AddressCity name -> pattern; the first match wins
+ADDRESS_CITIES = {
+    "Klaipėda": "Klaipėda|Klaipeda",
+    "Vilnius": "Vilnius",
+    "Kaunas": "Kaunas",
+}
+_ADDRESS_CITY_RE = [(name, re.compile(p, re.IGNORECASE)) for name, p in ADDRESS_CITIES.items()]
+
+#  Olay tarihi sütunu (ilk bulunan kullanılır); örnek dışa aktarımlarda yok
+DATE_COLUMNS = ("Data", "Įvykio data", "Date")
+
+_META_KEY = b"safeway_cube"
+
+
+def cube_path(name: str) -> Path:
+    return STORE_ROOT / "cube" / f"{name}.parquet"
+
+
+def _by_unique(values: pd.Series, fn) -> np.ndarray:
+    codes, uniques = pd.factorize(values.astype(object), use_na_sentinel=True)
+    mapped = np.array([fn(u) for u in uniques] + [None], dtype=object)
+    return mapped[codes]
+
+
+def _address_city(address):
+    return next((name for name, pattern in _ADDRESS_CITY_RE if pattern.search(address)), None)
+
+
+def aggregate(df: pd.DataFrame) -> pd.DataFrame:
+    """Counts of `df` (store rows) per dimension tuple."""
+    n = len(df)
+    year = pd.to_numeric(df[COL_YEAR].astype(object), errors="coerce")
+    dims = {"Metai": year.fillna(UNKNOWN).to_numpy(dtype=np.int16)}
+
+    date_col = next((c for c in DATE_COLUMNS if c in df.columns), None)
+    if date_col is not None:
+        date = pd.to_datetime(df[date_col], errors="coerce")
+        dims["Month"] = date.dt.month.fillna(UNKNOWN).to_numpy(dtype=np.int8)
+        dims["Weekday"] = (date.dt.weekday + 1).fillna(UNKNOWN).to_numpy(dtype=np.int8)
+    else:
+        dims["Month"] = np.full(n, UNKNOWN, dtype=np.int8)
+        dims["Weekday"] = np.full(n, UNKNOWN, dtype=np.int8)
+
+    if COL_TIME in df.columns:
+        t = df[COL_TIME].to_numpy(dtype=np.float64, na_value=np.nan)
+        hour = np.clip(np.floor(t * 24), 0, 23)
+        dims["Hour"] = np.where(np.isnan(t), UNKNOWN, hour).astype(np.int8)
+    else:
+        dims["Hour"] = np.full(n, UNKNOWN, dtype=np.int8)
+
+    city = np.full(n, None, dtype=object)
+    if COL_MUNICIPALITY_RAW in df.columns:
+        city = _by_unique(df[COL_MUNICIPALITY_RAW], normalize_municipality)
+    street = figure_street = mentioned = np.full(n, None, dtype=object)
+    if "address" in df.columns:
+        # Şehir ve sokak aynı önbellekli normalizer'dan
+        address_city, street = normalizer("risk").lookup(df["address"])
+        missing = pd.isna(city)
+        city[missing] = address_city[missing]
+        _, figure_street = normalizer("figure").lookup(df["address"])
+        mentioned = _by_unique(df["address"], _address_city)
+    dims["City"] = city
+    dims["Street"] = street
+    dims["FigureStreet"] = figure_street
+    dims["AddressCity"] = mentioned
+
+    return (
+        pd.DataFrame(dims)
+        .groupby(list(DIMENSIONS), dropna=False, sort=True)
+        .size()
+        .rename("Count")
+        .reset_index()
+    )
+
+
+def _year_partitions(name: str) -> dict:
+    """Year partition value -> fingerprint of its rows. Row order and file
+    layout do not matter: re-ingesting a workbook re-chunks the rows, and
+    the counts would not change anyway."""
+    root = accident_store.dataset_dir(name)
+    found = {}
+    for part in sorted(root.glob(f"{COL_YEAR}=*")):
+        df = ds.dataset(part, format="parquet", partitioning="hive").to_table().to_pandas()
+        df = df[sorted(df.columns)]
+        digest = pd.util.hash_pandas_object(df, index=False).to_numpy().sum(dtype=np.uint64)
+        found[part.name.split("=", 1)[1]] = f"{len(df)}:{int(digest):016x}"
+    return found
+
+
+def _version(path: Path):
+    meta = pq.read_schema(path).metadata or {}
+    return json.loads(meta.get(_META_KEY, b"{}")).get("version")
+
+
+def _read(name: str):
+    path = cube_path(name)
+    if not path.exists():
+        return None, {}
+    table = pq.read_table(path)
+    meta = json.loads((table.schema.metadata or {}).get(_META_KEY, b"{}"))
+    if meta.get("version") != CUBE_VERSION:
+        return None, {}
+    return table.to_pandas(), meta["partitions"]
+
+
+def _write(name: str, cube: pd.DataFrame, partitions: dict):
+    path = cube_path(name)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    table = pa.Table.from_pandas(cube, preserve_index=False)
+    table = table.replace_schema_metadata({
+        **(table.schema.metadata or {}),
+        _META_KEY: json.dumps({"version": CUBE_VERSION, "partitions": partitions}).encode("utf-8"),
+    })
+    # Paralel çizimde iki işçi aynı küpü yazabilir
+    tmp = path.with_name(f"{path.name}.{os.getpid()}.tmp")
+    pq.write_table(table, tmp)
+    tmp.replace(path)
+
+
+def refresh(name: str) -> tuple:
+    """Brings the cube of `name` up to date with the store. Returns
+    (years re-aggregated, years dropped)."""
+    partitions = _year_partitions(name)
+    cube, known = _read(name)
+    changed = sorted(y for y, h in partitions.items() if known.get(y) != h)
+    dropped = sorted(set(known) - set(partitions))
+    if cube is not None and not changed and not dropped:
+        return [], []
+
+    # Yıl bölümü tamsayı değilse (boş yıl) tüm veri baştan sayılır
+    if cube is None or not all(y.lstrip("-").isdigit() for y in changed + dropped):
+        fresh = aggregate(accident_store.load(name))
+        changed = sorted(partitions)
+    else:
+        years = [int(y) for y in changed]
+        stale = cube["Metai"].isin(years + [int(y) for y in dropped])
+        parts = [cube[~stale]]
+        if years:
+            parts.append(aggregate(accident_store.load(name, years=years)))
+        fresh = pd.concat(parts, ignore_index=True).sort_values(list(DIMENSIONS), kind="stable")
+    _write(name, fresh.reset_index(drop=True), partitions)
+    _cube.cache_clear()
+    return changed, dropped
+
+
+@lru_cache(maxsize=8)
+def _cube(name: str, mtime_ns: int) -> pd.DataFrame:
+    return pq.read_table(cube_path(name)).to_pandas()
+
+
+def cube(name: str) -> pd.DataFrame:
+    """The cube of dataset `name`, built on first use for stores ingested
+    before the cube (or this CUBE_VERSION of it) existed."""
+    accident_store._open(name)  # eskimiş depo önce yeniden alınır (küpü de tazeler)
+    path = cube_path(name)
+    if not path.exists() or _version(path) != CUBE_VERSION:
+        refresh(name)
+    return _cube(name, path.stat().st_mtime_ns)
+
+
+def query(cube_df: pd.DataFrame, by, **where) -> pd.Series:
+    """Sum of Count per `by` (a dimension or a list of them) over the rows
+    matching `where` (dimension=value or dimension=iterable of values).
+    Rows with an unknown value in a `by` dimension are left out."""
+    by = [by] if isinstance(by, str) else list(by)
+    unknown = [d for d in by + list(where) if d not in DIMENSIONS]
+    if unknown:
+        raise ValueError(f"unknown cube dimension(s) {unknown}; expected {DIMENSIONS}")
+    mask = np.ones(len(cube_df), dtype=bool)
+    for dim, value in where.items():
+        column = cube_df[dim]
+        if isinstance(value, (list, tuple, set, range, np.ndarray, pd.Index)):
+            mask &= column.isin(list(value)).to_numpy()
+        else:
+            mask &= (column == value).to_numpy()
+    for dim in by:
+        column = cube_df[dim]
+        mask &= column.notna().to_numpy()
+        if pd.api.types.is_numeric_dtype(column):
+            mask &= (column != UNKNOWN).to_numpy()
+    return cube_df[mask].groupby(by, sort=True)["Count"].sum()
+
+
+def counts(name: str, by, **where) -> pd.Series:
+    return query(cube(name), by, **where)
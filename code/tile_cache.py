@@ -0,0 +1,221 @@
+"""Local basemap tiles for the map figures (Fig.3-5 and Fig.6).
+
+`contextily.add_basemap` downloaded every tile on every render, and Fig.3-5
+quietly drew no basemap when that failed. Tiles now live in a directory
+pyramid, `<TILE_ROOT>/<provider>/<z>/<x>/<y>.png`, filled once by
+
+    python code/tile_cache.py prefetch                  # every figure area
+    python code/tile_cache.py prefetch --area Vilnius
+    python code/tile_cache.py stats
+
+and `add_basemap()` mosaics them from disk. Tiles missing from the store are
+downloaded on demand, unless SAFEWAY_TILES_OFFLINE is set (air-gapped
+builds): then a missing tile is an error that names the prefetch command.
+"""
+import argparse
+import math
+import os
+import sys
+import urllib.request
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+import numpy as np
+
+TILE_ROOT = Path(os.environ.get("SAFEWAY_TILES", "tile_cache"))
+OFFLINE = bool(os.environ.get("SAFEWAY_TILES_OFFLINE"))
+USER_AGENT = "SafeWay-thesis-figures/1.0"
+TILE_SIZE = 256
+
+#  Web mercator (EPSG:3857) half extent in metres
+ORIGIN = 20037508.342789244
+
+#  name -> (URL template, subdomains, attribution)
+PROVIDERS = {
+    "CartoDB.Positron": ("https://{s}.basemaps.cartocdn.com/light_all/{z}/{x}/{y}.png", "abcd",
+                         "(C) OpenStreetMap contributors (C) CARTO"),
+    "OpenStreetMap.Mapnik": ("https://tile.openstreetmap.org/{z}/{x}/{y}.png", "",
+                             "(C) OpenStreetMap contributors"),
+}
+
+#  Fig.3-5 pencere yarıçapı (km, EPSG:3857 birimi) ve şehir merkezi (lon, lat)
+CITY_WINDOW_KM = {"Kaunas": 25, "Vilnius": 30, "Klaipėda": 20}
+CITY_CENTRES = {"Kaunas": (23.9036, 54.8985), "Vilnius": (25.2797, 54.6872), "Klaipėda": (21.1443, 55.7033)}
+
+#  The Fig.3-5 windows follow the data median, so their area is prefetched
+#  with this much slack around the city centre
+CITY_MARGIN = 1.5
+
+
+def suggest_zoom(radius_km: float) -> int:
+    """Şehir yarıçapına göre güvenli zoom önerisi (0–20)."""
+    if radius_km <= 8:   return 15
+    if radius_km <= 12:  return 14
+    if radius_km <= 20:  return 13
+    if radius_km <= 30:  return 12
+    return 11
+
+
+def to_mercator(lon, lat):
+    x = math.radians(lon) * ORIGIN / math.pi
+    y = math.log(math.tan(math.pi / 4 + math.radians(lat) / 2)) * ORIGIN / math.pi
+    return x, y
+
+
+def to_lonlat(x, y):
+    lon = math.degrees(x * math.pi / ORIGIN)
+    lat = math.degrees(2 * math.atan(math.exp(y * math.pi / ORIGIN)) - math.pi / 2)
+    return lon, lat
+
+
+def auto_zoom(xmin, ymin, xmax, ymax) -> int:
+    """The zoom contextily picks for an extent when none is given."""
+    west, south = to_lonlat(xmin, ymin)
+    east, north = to_lonlat(xmax, ymax)
+    lon_zoom = math.ceil(math.log2(360 * 2.0 / (east - west)))
+    lat_zoom = math.ceil(math.log2(360 * 2.0 / (north - south)))
+    return int(max(lon_zoom, lat_zoom))
+
+
+def tile_range(xmin, ymin, xmax, ymax, zoom):
+    """(x0, x1, y0, y1) inclusive tile indices covering a 3857 extent."""
+    n = 2 ** zoom
+    size = 2 * ORIGIN / n
+
+    def clamp(v):
+        return min(max(int(v), 0), n - 1)
+
+    return (clamp((xmin + ORIGIN) // size), clamp((xmax + ORIGIN) // size),
+            clamp((ORIGIN - ymax) // size), clamp((ORIGIN - ymin) // size))
+
+
+def tile_path(provider, z, x, y) -> Path:
+    return TILE_ROOT / provider / str(z) / str(x) / f"{y}.png"
+
+
+def fetch_tile(provider, z, x, y) -> Path:
+    template, subdomains, _ = PROVIDERS[provider]
+    url = template.format(s=subdomains[(x + y) % len(subdomains)] if subdomains else "", z=z, x=x, y=y)
+    request = urllib.request.Request(url, headers={"User-Agent": USER_AGENT})
+    with urllib.request.urlopen(request, timeout=30) as response:
+        data = response.read()
+    path = tile_path(provider, z, x, y)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    tmp = path.with_name(f"{path.name}.{os.getpid()}.tmp")
+    tmp.write_bytes(data)
+    tmp.replace(path)
+    return path
+
+
+def _missing(provider, zoom, bounds):
+    x0, x1, y0, y1 = tile_range(*bounds, zoom)
+    return [(zoom, x, y) for x in range(x0, x1 + 1) for y in range(y0, y1 + 1)
+            if not tile_path(provider, zoom, x, y).exists()]
+
+
+def _fetch_all(provider, tiles, threads=2):
+    """Downloads `tiles`; returns the ones that failed."""
+    def one(tile):
+        try:
+            fetch_tile(provider, *tile)
+            return None
+        except Exception as e:
+            return tile, e
+
+    # Karo sunucularının kullanım kurallarına uygun, az sayıda bağlantı
+    with ThreadPoolExecutor(max_workers=threads) as pool:
+        return [f for f in pool.map(one, tiles) if f is not None]
+
+
+def add_basemap(ax, provider, zoom=None, alpha=1.0, attribution=True):
+    """Draws `provider` tiles under the current extent of `ax` (EPSG:3857)
+    and keeps that extent, like `ctx.add_basemap(..., reset_extent=False)`."""
+    xlim, ylim = ax.get_xlim(), ax.get_ylim()
+    bounds = (min(xlim), min(ylim), max(xlim), max(ylim))
+    if zoom is None:
+        zoom = auto_zoom(*bounds)
+
+    missing = _missing(provider, zoom, bounds)
+    if missing and OFFLINE:
+        raise FileNotFoundError(
+            f"{len(missing)} {provider} tile(s) at zoom {zoom} missing from {TILE_ROOT}; "
+            f"run `python code/tile_cache.py prefetch` on a machine with network access")
+    failed = _fetch_all(provider, missing) if missing else []
+    if failed:
+        raise OSError(f"{len(failed)} {provider} tile(s) could not be downloaded, e.g. "
+                      f"{failed[0][0]}: {failed[0][1]}")
+
+    import matplotlib.pyplot as plt
+    x0, x1, y0, y1 = tile_range(*bounds, zoom)
+    mosaic = np.zeros(((y1 - y0 + 1) * TILE_SIZE, (x1 - x0 + 1) * TILE_SIZE, 4), dtype=np.float32)
+    for x in range(x0, x1 + 1):
+        for y in range(y0, y1 + 1):
+            tile = plt.imread(tile_path(provider, zoom, x, y))
+            if tile.dtype == np.uint8:
+                tile = tile.astype(np.float32) / 255
+            if tile.ndim == 2:
+                tile = np.repeat(tile[:, :, None], 3, axis=2)
+            if tile.shape[2] == 3:
+                tile = np.concatenate([tile, np.ones(tile.shape[:2] + (1,), np.float32)], axis=2)
+            r, c = (y - y0) * TILE_SIZE, (x - x0) * TILE_SIZE
+            mosaic[r:r + TILE_SIZE, c:c + TILE_SIZE] = tile[:TILE_SIZE, :TILE_SIZE]
+
+    size = 2 * ORIGIN / 2 ** zoom
+    extent = (-ORIGIN + x0 * size, -ORIGIN + (x1 + 1) * size,
+              ORIGIN - (y1 + 1) * size, ORIGIN - y0 * size)
+    ax.imshow(mosaic, extent=extent, interpolation="bilinear", alpha=alpha, zorder=0)
+    ax.set_xlim(xlim)
+    ax.set_ylim(ylim)
+    if attribution:
+        ax.text(0.005, 0.005, PROVIDERS[provider][2], transform=ax.transAxes,
+                fontsize=6, alpha=0.8, ha="left", va="bottom", zorder=10)
+
+
+def figure_areas():
+    """name -> (provider, zoom, 3857 bounds) the map figures draw."""
+    areas = {}
+    for city, km in CITY_WINDOW_KM.items():
+        cx, cy = to_mercator(*CITY_CENTRES[city])
+        r = km * 1000 * CITY_MARGIN
+        areas[city] = ("CartoDB.Positron", suggest_zoom(km), (cx - r, cy - r, cx + r, cy + r))
+    # Fig.6: Vilnius merkezi çevresinde sabit 6 km pencere, zoom otomatik
+    cx, cy = to_mercator(*CITY_CENTRES["Vilnius"])
+    bounds = (cx - 6000, cy - 6000, cx + 6000, cy + 6000)
+    areas["Vilnius-central"] = ("OpenStreetMap.Mapnik", auto_zoom(*bounds), bounds)
+    return areas
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Local basemap tile store")
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("prefetch")
+    p.add_argument("--area", action="append", help="default: every figure area")
+    p.add_argument("--threads", type=int, default=2)
+    sub.add_parser("stats")
+    args = parser.parse_args()
+
+    areas = figure_areas()
+    if args.command == "stats":
+        for name, (provider, zoom, bounds) in areas.items():
+            x0, x1, y0, y1 = tile_range(*bounds, zoom)
+            total = (x1 - x0 + 1) * (y1 - y0 + 1)
+            print(f"{name}: {provider} z{zoom}, {total - len(_missing(provider, zoom, bounds))}/{total} tiles")
+        return
+
+    unknown = set(args.area or ()) - set(areas)
+    if unknown:
+        parser.error(f"unknown area(s) {', '.join(sorted(unknown))}; known: {', '.join(areas)}")
+    failed = 0
+    for name in args.area or areas:
+        provider, zoom, bounds = areas[name]
+        missing = _missing(provider, zoom, bounds)
+        errors = _fetch_all(provider, missing, args.threads)
+        failed += len(errors)
+        print(f"[{'FAIL' if errors else 'OK'}] {name}: {provider} z{zoom}, "
+              f"{len(missing) - len(errors)} downloaded, {len(errors)} failed -> {TILE_ROOT / provider}")
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,21 +1,15 @@
 import pandas as pd
 import matplotlib.pyplot as plt
+import sys
+from pathlib import Path
 
-# excel dosyasının yolunu burada tanımlıyorum
-file_path = '2020-2024m_EI-duomenys_viesinama.xlsx'
-df = pd.read_excel(file_path, sheet_name='2020-2024')
+# ortak veri yükleyicisi code/ klasöründe
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+from temporal_cube import counts
 
-# laikas sütununda boş olan satırları atıyorum
-df = df[df['Laikas'].notnull()]
-
-# saat bilgisini datetime'a çevirip sadece saati alıyorum
-df['Hour'] = pd.to_datetime(df['Laikas'], format='%H:%M:%S', errors='coerce').dt.hour
-
-# çevrilemeyen (NaT olan) saatleri temizliyorum
-df = df[df['Hour'].notnull()]
-
-# her saat için kaza sayısını saydırıyorum
-hourly_counts = df['Hour'].value_counts().sort_index()
+# saatlik kaza sayıları depodaki zaman küpünden geliyor (laikas zaten günün
+# kesri olarak saklandığı için saat = laikas * 24); laikas boş olanlar yok
+hourly_counts = counts('raw', 'Hour')
 
 # grafiği burada çizdiriyorum
 plt.figure(figsize=(12, 6))
@@ -1,36 +1,25 @@
 import pandas as pd
 import matplotlib.pyplot as plt
+import sys
+from pathlib import Path
 
-# excel dosyasının yolunu burada tanımladım
-file_path = "2020-2024m_EI-duomenys_viesinama.xlsx"
+# ortak veri yükleyicisi code/ klasöründe
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+from temporal_cube import counts
 
-# ilgili sayfayı excelden okuyorum
-df = pd.read_excel(file_path, sheet_name="2020-2024")
-
-# sadece 2024 yılına ait satırları alıyorum
-df_2024 = df[df["Metai"] == 2024]
-
-# laikas sütunu boş olmayan kayıtları bırakıyorum
-df_2024 = df_2024[df_2024["Laikas"].notnull()]
-
-# laikas ondalık olduğu için 24 ile çarpıp saat bilgisini çıkarıyorum
-df_2024["Hour"] = (df_2024["Laikas"] * 24).astype(int)
+# 2024 için saatlik kaza sayılarını zaman küpünden alıyorum (laikas boş olanlar hariç)
+hourly_2024 = counts("raw", "Hour", Metai=2024)
 
 # 2 saatlik zaman dilimlerini burada tanımlıyorum
-time_bins = list(range(0, 25, 2))  # 0, 2, 4, ..., 24
 time_labels = [
    "00:00–02:00", "02:00–04:00", "04:00–06:00", "06:00–08:00",
    "08:00–10:00", "10:00–12:00", "12:00–14:00", "14:00–16:00",
    "16:00–18:00", "18:00–20:00", "20:00–22:00", "22:00–00:00"
 ]
 
-# her kaydı ilgili zaman aralığına yerleştiriyorum
-df_2024["Time Slot"] = pd.cut(df_2024["Hour"], bins=time_bins, labels=time_labels, right=False)
-
-# her zaman dilimi için toplam kaza sayısını hesaplıyorum
-time_slot_counts = df_2024["Time Slot"].value_counts().sort_index()
-time_slot_counts_df = time_slot_counts.reset_index()
-time_slot_counts_df.columns = ["Time Slot", "Accident Count"]
+# her saati kendi 2 saatlik dilimine toplayıp boş dilimleri 0 ile dolduruyorum
+slot_counts = hourly_2024.groupby(hourly_2024.index // 2).sum().reindex(range(12), fill_value=0)
+time_slot_counts_df = pd.DataFrame({"Time Slot": time_labels, "Accident Count": slot_counts.to_numpy()})
 
 # çizgi grafiğini burada oluşturuyorum
 plt.figure(figsize=(12, 6))
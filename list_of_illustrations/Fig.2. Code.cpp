@@ -2,7 +2,12 @@ import pandas as pd
 import matplotlib
 matplotlib.use("TkAgg")
 import matplotlib.pyplot as plt
-import re
+import sys
+from pathlib import Path
+
+# ortak veri yükleyicisi code/ klasöründe
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+from temporal_cube import counts
 
 # burada varsayılan çizim stilini seçmeye çalışıyorum
 try:
@@ -10,52 +15,26 @@ try:
 except OSError:
    plt.style.use("ggplot")
 
-# kaza verilerini excelden içeri alıyorum
-df = pd.read_excel("kaza_adresli.xlsx")
 # çalışacağım yıl aralığını burada tanımladım
 years = list(range(2020, 2025))
-# yıl sütununu tam sayıya çeviriyorum ki filtrelemesi kolay olsun
-df["Metai"] = df["Metai"].astype(int)
-
-# adres bilgisinden sokak ismini çekmek için küçük bir fonksiyon
-def extract_street(addr):
-   if pd.isna(addr):
-       return None
-   addr = str(addr)
-   pattern = r"([\wÀ-ž\.\- ]+?\s(?:g\.|pl\.|pr\.|kel\.|al\.|gatvė|prospektas|kelias|alėja))"
-   m = re.search(pattern, addr)
-   if m:
-       return m.group(1).strip()
-   parts = addr.split(",")
-   if len(parts) > 1:
-       return parts[1].strip()
-   return addr.strip()
-
-# her satır için yukarıdaki fonksiyonla sokak adını çıkarıyorum
-df["Street"] = df["address"].apply(extract_street)
 
 # klaipeda için en çok kaza olan sokakların yıllara göre trendini hazırlayan fonksiyon
 def get_top_street_trend_klaipeda(n_top=5):
-   city_df = df[
-       (df["Metai"].between(2020, 2024)) &
-       (df["address"].str.contains("Klaipėda|Klaipeda", case=False, na=False))
-   ].copy()
+   # yıl + sokak kaza sayıları zaman küpünden; adresinde "Klaipėda" geçenler,
+   # sokak adı şekil kuralıyla (eskisiyle aynı seçim)
+   yearly = counts("addressed", ["Metai", "FigureStreet"], AddressCity="Klaipėda", Metai=years)
+   yearly = yearly.rename_axis(["Metai", "Street"])
 
    # sokaklara göre toplam kaza sayısını hesaplıyorum
    street_counts = (
-       city_df.groupby("Street").size().sort_values(ascending=False)
+       yearly.groupby(level="Street").sum().sort_values(ascending=False)
    )
-   # en çok kazaya sahip ilk n sokak
+   # en çok kazaya sahip ilk n sokağın listesini alıyorum
    top_streets = street_counts.head(n_top).index.tolist()
 
-   # sadece bu seçilen sokakları filtreliyorum
-   top_df = city_df[city_df["Street"].isin(top_streets)]
-
-   # yıl + sokak kombinasyonuna göre tabloyu pivotluyorum
+   # sadece bu sokakları yıl x sokak tablosuna açıyorum
    trend_df = (
-       top_df
-       .groupby(["Metai", "Street"])
-       .size()
+       yearly[yearly.index.get_level_values("Street").isin(top_streets)]
        .unstack("Street")
        .reindex(years, fill_value=0)
    )
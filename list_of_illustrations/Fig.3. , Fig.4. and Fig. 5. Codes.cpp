@@ -2,11 +2,15 @@ import pandas as pd
 import numpy as np
 import matplotlib.pyplot as plt
 import geopandas as gpd
-import contextily as ctx
 from pathlib import Path
+import sys
+
+# ortak veri yükleyicisi code/ klasöründe
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+from accident_store import load
+from tile_cache import CITY_WINDOW_KM, add_basemap, suggest_zoom
 
 # temel ayarları burada tutuyorum
-EXCEL_PATH = "2020-2024m_EI-duomenys_viesinama.xlsx"
 YEAR_TARGET = 2024
 OUTPUT_DIR = Path("outputs_points_2024")
 OUTPUT_DIR.mkdir(exist_ok=True)
@@ -29,25 +33,17 @@ def normalize_city(name: str):
        return "Klaipėda"
    return None
 
-# her şehir için kullanacağım pencere yarıçapı (km)
-CITY_WINDOW_KM = {"Kaunas": 25, "Vilnius": 30, "Klaipėda": 20}
-
 # km'yi metreye çeviriyorum
 def km_to_m(km: float) -> float:
    return float(km) * 1000.0
 
-# şehir yarıçapına göre kabaca zoom seviyesi seçiyorum
-def suggest_zoom(radius_km: float) -> int:
-   """Şehir yarıçapına göre güvenli zoom önerisi (0–20)."""
-   if radius_km <= 8:   return 15
-   if radius_km <= 12:  return 14
-   if radius_km <= 20:  return 13
-   if radius_km <= 30:  return 12
-   return 11
-
-# veriyi excelden çekip temel temizliği yapıyorum
-df = pd.read_excel(EXCEL_PATH)
-df = df[[COL_YEAR, COL_X, COL_Y, COL_CITY_RAW]].copy()
+# veriyi depodan çekiyorum: sadece hedef yıl ve üç şehrin bölümleri okunuyor
+df = load(
+   "raw",
+   columns=[COL_YEAR, COL_X, COL_Y, COL_CITY_RAW],
+   years=[YEAR_TARGET],
+   municipality=lambda m: normalize_city(m) is not None,
+)
 for c in [COL_YEAR, COL_X, COL_Y]:
    df[c] = pd.to_numeric(df[c], errors="coerce")
 
@@ -118,19 +114,15 @@ def make_city_points_2024(gdf_all: gpd.GeoDataFrame, city: str,
    ax.set_xlim([xmin, xmax])
    ax.set_ylim([ymin, ymax])
 
-   # sonra altlık haritayı eklemeyi deniyorum
+   # sonra altlık haritayı yerel karo deposundan ekliyorum (code/tile_cache.py)
    try:
        rad_km = CITY_WINDOW_KM.get(city, 20)
-       z = suggest_zoom(rad_km)
-       ctx.add_basemap(
-           ax,
-           crs="EPSG:3857",
-           source=ctx.providers.CartoDB.Positron,
-           zoom=z,
-           reset_extent=False
-       )
-   except Exception as e:
-       print(f"[INFO] Basemap eklenemedi: {e}. Altlık olmadan devam.")
+       add_basemap(ax, "CartoDB.Positron", zoom=suggest_zoom(rad_km))
+   except FileNotFoundError:
+       # çevrimdışı modda eksik karo: altlıksız çizmek yerine hata versin
+       raise
+   except OSError as e:
+       print(f"[WARN] Basemap eklenemedi, altlıksız çiziliyor: {e}")
 
    # kaza noktalarını siyah dolu beyaz kenarlıkla çiziyorum
    sub.plot(
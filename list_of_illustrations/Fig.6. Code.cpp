@@ -6,11 +6,16 @@ import matplotlib
 # ekranda açmadan sadece dosyaya kaydedeyim diye agg kullanıyorum
 matplotlib.use('Agg')
 import matplotlib.pyplot as plt
-from sklearn.cluster import DBSCAN
+import sys
+from pathlib import Path
+
+# sklearn DBSCAN ile aynı etiketleri veren grid tabanlı sürüm code/ klasöründe
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+from grid_dbscan import GridDBSCAN
+from tile_cache import add_basemap
 
 import geopandas as gpd
 from shapely.geometry import Point
-import contextily as ctx
 
 
 def main():
@@ -73,7 +78,7 @@ def main():
     EPS_METERS = 600.0   # küme yarıçapı yaklaşık 600 m
     MIN_SAMPLES = 3      # en az 3 nokta olursa küme sayıyorum
 
-    dbscan = DBSCAN(eps=EPS_METERS, min_samples=MIN_SAMPLES)
+    dbscan = GridDBSCAN(eps=EPS_METERS, min_samples=MIN_SAMPLES)
     labels = dbscan.fit_predict(X)
     gdf_3857["cluster"] = labels
 
@@ -101,12 +106,8 @@ def main():
     # önce harita sınırlarını ayarlıyorum
     ax.set_xlim(x_min, x_max)
     ax.set_ylim(y_min, y_max)
-    ctx.add_basemap(
-        ax,
-        source=ctx.providers.OpenStreetMap.Mapnik,
-        crs="EPSG:3857",
-        alpha=0.4
-    )
+    # altlık karolar yerel depodan (code/tile_cache.py)
+    add_basemap(ax, "OpenStreetMap.Mapnik", alpha=0.4)
 
     # kümeye girmeyen noktaları küçük gri olarak çiziyorum
     noise_mask = (gdf_3857["cluster"] == -1)
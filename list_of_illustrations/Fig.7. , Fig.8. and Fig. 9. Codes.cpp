@@ -3,10 +3,16 @@ matplotlib.use('TkAgg')
 import pandas as pd
 import matplotlib.pyplot as plt
 import os
-import re
+import sys
+from pathlib import Path
 
-# exceldeki kaza verisini buradan içeri alıyorum
-df = pd.read_excel("kaza_adresli.xlsx")
+# ortak veri yükleyicisi code/ klasöründe
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "code"))
+from accident_store import load
+from street_normalizer import streets
+
+# kaza verisini parquet deposundan (kaza_adresli) içeri alıyorum
+df = load("addressed", columns=["Metai", "address", "Latitude", "Longitude"])
 
 # vilnius ve 2020–2024 yılları için satırları filtreliyorum
 vilnius_df = df[
@@ -14,26 +20,8 @@ vilnius_df = df[
     (df['address'].str.contains("Vilnius", case=False, na=False))
 ].copy()
 
-# adres içinden regex ile sokak adını çekiyorum
-regex_pattern = r'(\b[\wÀ-ž\s\-\.]+?\s?(g\.|pl\.|pr\.|kel\.|al\.|gatvė|prospektas|kelias|alėja))'
-vilnius_df['clean_street'] = vilnius_df['address'].str.extract(regex_pattern, expand=False)[0]
-vilnius_df['clean_street'] = vilnius_df['clean_street'].fillna("Bilinmeyen")
-
-# sokak adı bulunamazsa yedek çıkarım yapan küçük fonksiyon
-def backup_street(parts, existing):
-    if existing != "Bilinmeyen":
-        return existing
-    for p in parts:
-        if re.search(r'\b(g\.|pl\.|pr\.|kel\.|al\.|gatvė|prospektas|kelias|alėja)\b', p.strip(), re.IGNORECASE):
-            return p.strip()
-    return parts[2].strip() if len(parts) >= 3 else "Bilinmeyen"
-
-# adresleri virgüle göre parçalayıp final sokak ismini belirliyorum
-vilnius_df['address_parts'] = vilnius_df['address'].str.split(',')
-vilnius_df['final_street'] = [
-    backup_street(parts, original)
-    for parts, original in zip(vilnius_df['address_parts'], vilnius_df['clean_street'])
-]
+# sokak adını ortak normalizer ile çıkarıyorum (scripts 3/4 ile aynı kural)
+vilnius_df['final_street'] = streets(vilnius_df['address'])
 
 # sadece laisvės pr. satırlarını ve koordinatlarını alıyorum
 laisves_coords = vilnius_df[